@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.graphics.Color
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import kotlin.math.roundToInt
+
+// Check the Vulkan histogram, LUT and 3D LUT kernels against the same operations on the CPU.
+@RunWith(AndroidJUnit4::class)
+class ColorLookupTest {
+    companion object {
+        // The size of each dimension of the identity 3D LUT.
+        private const val LUT_3D_SIZE = 17
+
+        // The 3D LUT entries are quantized to 8 bits, and interpolated by the sampler with
+        // a limited precision.
+        private const val MAX_LUT_3D_ERROR = 2
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mInputImage: Bitmap
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mInputImage = loadTestBitmap(context)
+        mProcessor = VulkanImageProcessor(context)
+        mProcessor.configureInputAndOutput(mInputImage, 2)
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    @Test
+    fun histogramMatchesCpu() {
+        val expected = IntArray(256 * 4)
+        for (pixel in readPixels(mInputImage)) {
+            expected[Color.red(pixel) * 4 + 0]++
+            expected[Color.green(pixel) * 4 + 1]++
+            expected[Color.blue(pixel) * 4 + 2]++
+            expected[Color.alpha(pixel) * 4 + 3]++
+        }
+        assertArrayEquals(expected, mProcessor.histogram())
+    }
+
+    @Test
+    fun lutMatchesCpu() {
+        val red = ByteArray(256) { v -> (255 - v).toByte() }
+        val green = ByteArray(256) { v -> (v / 2).toByte() }
+        val blue = ByteArray(256) { v -> v.toByte() }
+        val alpha = ByteArray(256) { 255.toByte() }
+        val expected = readPixels(mInputImage).map { pixel ->
+            Color.argb(
+                255,
+                255 - Color.red(pixel),
+                Color.green(pixel) / 2,
+                Color.blue(pixel)
+            )
+        }.toIntArray()
+        val actual = readPixels(mProcessor.lut(red, green, blue, alpha, 0))
+        assertEquals(0, compareImages(expected, actual).maxAbsError)
+    }
+
+    @Test
+    fun identityLut3DPreservesColors() {
+        val table = ByteArray(LUT_3D_SIZE * LUT_3D_SIZE * LUT_3D_SIZE * 4)
+        val entry = { i: Int -> (i * 255.0 / (LUT_3D_SIZE - 1)).roundToInt().toByte() }
+        for (b in 0 until LUT_3D_SIZE) {
+            for (g in 0 until LUT_3D_SIZE) {
+                for (r in 0 until LUT_3D_SIZE) {
+                    val index = ((b * LUT_3D_SIZE + g) * LUT_3D_SIZE + r) * 4
+                    table[index + 0] = entry(r)
+                    table[index + 1] = entry(g)
+                    table[index + 2] = entry(b)
+                    table[index + 3] = 255.toByte()
+                }
+            }
+        }
+        val actual = readPixels(
+            mProcessor.lut3D(table, LUT_3D_SIZE, LUT_3D_SIZE, LUT_3D_SIZE, 0)
+        )
+        val difference = compareImages(readPixels(mInputImage), actual)
+        assertTrue(
+            "Max abs error ${difference.maxAbsError}",
+            difference.maxAbsError <= MAX_LUT_3D_ERROR
+        )
+    }
+}
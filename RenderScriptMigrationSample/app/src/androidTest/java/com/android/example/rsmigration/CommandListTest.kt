@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check that the filters executed in a batch by a command list match the filters called one by
+// one, and that the statuses are reported per command.
+@RunWith(AndroidJUnit4::class)
+class CommandListTest {
+    companion object {
+        private const val NUM_OUTPUTS = 3
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mProcessor = VulkanImageProcessor(context)
+        mProcessor.configureInputAndOutput(loadTestBitmap(context), NUM_OUTPUTS)
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    @Test
+    fun batchMatchesSingleCalls() {
+        val expected = listOf(
+            readPixels(mProcessor.rotateHue(1.0f, 0)),
+            readPixels(mProcessor.blur(10.0f, 1)),
+            readPixels(mProcessor.pyramidBlur(20.0f, 0.5f, 2))
+        )
+
+        val commandList = VulkanCommandList()
+            .rotateHue(1.0f, 0)
+            .blur(10.0f, 1)
+            .pyramidBlur(20.0f, 0.5f, 2)
+            .waitForCompletion()
+        assertTrue(mProcessor.execute(commandList))
+        for (i in 0 until commandList.size) {
+            assertEquals(VulkanCommandList.Status.SUCCESS, commandList.status(i))
+            assertTrue(commandList.elapsedNanos(i) > 0L)
+        }
+        val outputs = (0 until NUM_OUTPUTS).map { readPixels(mProcessor.getOutputImage(it)) }
+        for (i in expected.indices) assertArrayEquals("Output $i", expected[i], outputs[i])
+    }
+
+    @Test
+    fun failedCommandDoesNotStopTheList() {
+        // The blur filter only supports radii up to 25.
+        val commandList = VulkanCommandList()
+            .blur(100.0f, 0)
+            .rotateHue(1.0f, 1)
+            .waitForCompletion()
+        assertFalse(mProcessor.execute(commandList))
+        assertEquals(VulkanCommandList.Status.FAILED, commandList.status(0))
+        assertEquals(VulkanCommandList.Status.SUCCESS, commandList.status(1))
+        assertEquals(VulkanCommandList.Status.SUCCESS, commandList.status(2))
+    }
+
+    @Test
+    fun outputIndexOutOfRangeIsInvalid() {
+        val commandList = VulkanCommandList()
+            .rotateHue(1.0f, 0)
+            .blur(10.0f, NUM_OUTPUTS)
+            .waitForCompletion()
+        assertFalse(mProcessor.execute(commandList))
+        assertEquals(VulkanCommandList.Status.SUCCESS, commandList.status(0))
+        assertEquals(VulkanCommandList.Status.INVALID, commandList.status(1))
+        assertEquals(VulkanCommandList.Status.NOT_EXECUTED, commandList.status(2))
+    }
+}
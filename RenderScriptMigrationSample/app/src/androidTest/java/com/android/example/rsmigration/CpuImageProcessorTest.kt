@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.graphics.Color
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check that the native CPU processor matches the Vulkan processor up to rounding, and that its
+// results do not depend on the number of threads. The box blurs are also checked against a direct
+// box filter, as the Vulkan ones have no other reference, and the fused color adjustment against
+// the separate filters.
+@RunWith(AndroidJUnit4::class)
+class CpuImageProcessorTest {
+    companion object {
+        // The CPU filters compute in fixed point or float, and may round differently from the GPU.
+        private const val MAX_ABS_ERROR = 1
+
+        // The recursive blur approximates the gaussian of blur closely only for larger radii.
+        private val RECURSIVE_BLUR_RADII = floatArrayOf(10.0f, 25.0f)
+        private const val MIN_RECURSIVE_BLUR_PSNR_DB = 40.0
+
+        // The box blurs support much larger radii than blur.
+        private val BOX_BLUR_RADII = floatArrayOf(1.0f, 4.5f, 25.0f, 100.0f)
+
+        // adjustColors keeps the intermediate results in float, so it may differ from the separate
+        // filters by one rounding step per kernel, see PixelKernel.h.
+        private const val MAX_FUSED_ABS_ERROR = 3
+
+                init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mVulkanProcessor: VulkanImageProcessor
+    private lateinit var mCpuProcessor: CpuImageProcessor
+    private lateinit var mSingleThreadedProcessor: CpuImageProcessor
+    private lateinit var mInput: Bitmap
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val input = loadTestBitmap(context)
+        mInput = input
+        mVulkanProcessor = VulkanImageProcessor(context)
+        mCpuProcessor = CpuImageProcessor()
+        mSingleThreadedProcessor = CpuImageProcessor(numThreads = 1)
+        for (processor in listOf(mVulkanProcessor, mCpuProcessor, mSingleThreadedProcessor)) {
+            processor.configureInputAndOutput(input, 1)
+        }
+    }
+
+    @After
+    fun tearDown() {
+        mVulkanProcessor.cleanup()
+        mCpuProcessor.cleanup()
+        mSingleThreadedProcessor.cleanup()
+    }
+
+    private fun checkFilter(filter: (ImageProcessor) -> Bitmap, label: String) =
+        checkFilter(filter, filter, label)
+
+    // Same as above for the filters outside of the ImageProcessor interface.
+    private fun checkFilter(
+        vulkanFilter: (VulkanImageProcessor) -> Bitmap,
+        cpuFilter: (CpuImageProcessor) -> Bitmap,
+        label: String
+    ) {
+        val expected = readPixels(vulkanFilter(mVulkanProcessor))
+        val actual = readPixels(cpuFilter(mCpuProcessor))
+        val difference = compareImages(expected, actual)
+        assertTrue(
+            "$label: max_abs_error = ${difference.maxAbsError}",
+            difference.maxAbsError <= MAX_ABS_ERROR
+        )
+        assertArrayEquals(label, actual, readPixels(cpuFilter(mSingleThreadedProcessor)))
+    }
+
+    @Test
+    fun rotateHueMatchesVulkan() {
+        for (radian in floatArrayOf(-3.0f, -1.0f, 0.5f, 2.0f)) {
+            checkFilter({ it.rotateHue(radian, 0) }, "rotateHue($radian)")
+        }
+    }
+
+    @Test
+    fun saturationMatchesVulkan() {
+        for (saturation in floatArrayOf(0.0f, 0.5f, 1.0f, 2.0f)) {
+            checkFilter(
+                { it.saturation(saturation, 0) },
+                { it.saturation(saturation, 0) },
+                "saturation($saturation)"
+            )
+        }
+    }
+
+    @Test
+    fun blurMatchesVulkan() {
+        for (radius in floatArrayOf(1.0f, 4.5f, 10.0f, 25.0f)) {
+            checkFilter({ it.blur(radius, 0) }, "blur($radius)")
+        }
+    }
+
+    @Test
+    fun recursiveBlurApproximatesBlur() {
+        for (radius in RECURSIVE_BLUR_RADII) {
+            val label = "recursiveBlur($radius)"
+            val expected = readPixels(mCpuProcessor.blur(radius, 0))
+            val actual = readPixels(mCpuProcessor.recursiveBlur(radius, 0))
+            val difference = compareImages(expected, actual)
+            assertTrue(
+                "$label: psnr = ${difference.psnr}",
+                difference.psnr >= MIN_RECURSIVE_BLUR_PSNR_DB
+            )
+            assertArrayEquals(
+                label, actual, readPixels(mSingleThreadedProcessor.recursiveBlur(radius, 0))
+            )
+        }
+    }
+
+    @Test
+    fun boxBlurMatchesReference() {
+        val pixels = readPixels(mInput)
+        for (radius in BOX_BLUR_RADII) {
+            val label = "boxBlur($radius)"
+            val expected = referenceBoxBlur(pixels, mInput.width, mInput.height, radius)
+            val difference = compareImages(expected, readPixels(mCpuProcessor.boxBlur(radius, 0)))
+            assertTrue(
+                "$label: max_abs_error = ${difference.maxAbsError}",
+                difference.maxAbsError <= MAX_ABS_ERROR
+            )
+        }
+    }
+
+    @Test
+    fun boxBlurMatchesVulkan() {
+        for (radius in BOX_BLUR_RADII) {
+            checkFilter({ it.boxBlur(radius, 0) }, { it.boxBlur(radius, 0) }, "boxBlur($radius)")
+        }
+    }
+
+    @Test
+    fun stackedBoxBlurMatchesVulkan() {
+        for (radius in BOX_BLUR_RADII) {
+            checkFilter(
+                { it.stackedBoxBlur(radius, 0) },
+                { it.stackedBoxBlur(radius, 0) },
+                "stackedBoxBlur($radius)"
+            )
+        }
+    }
+
+    @Test
+    fun adjustColorsMatchesSequentialFilters() {
+        val pixels = readPixels(mInput)
+        // A table with a slope below 1, so the rounding differences are not amplified.
+        val table = ByteArray(256) { (32 + it * 3 / 4).toByte() }
+        val identity = ByteArray(256) { it.toByte() }
+        val inRange = { pixel: Int ->
+            intArrayOf(Color.red(pixel), Color.green(pixel), Color.blue(pixel)).all { it in 1..254 }
+        }
+        for (radian in floatArrayOf(-1.0f, 0.5f)) {
+            for (saturation in floatArrayOf(0.5f, 1.5f)) {
+                val label = "adjustColors($radian, $saturation)"
+                val hue = referenceRotateHue(pixels, radian)
+                val saturated = referenceSaturation(hue, saturation)
+                val expected = referenceLut(saturated, table, table, table)
+                val actual = readPixels(
+                    mCpuProcessor.adjustColors(
+                        radian, saturation, table, table, table, identity, 0
+                    )
+                )
+                // The fused chain only matches where no intermediate result was clamped.
+                val indices = pixels.indices.filter { inRange(hue[it]) && inRange(saturated[it]) }
+                assertTrue(label, indices.isNotEmpty())
+                val difference = compareImages(
+                    IntArray(indices.size) { expected[indices[it]] },
+                    IntArray(indices.size) { actual[indices[it]] }
+                )
+                assertTrue(
+                    "$label: max_abs_error = ${difference.maxAbsError}",
+                    difference.maxAbsError <= MAX_FUSED_ABS_ERROR
+                )
+                assertArrayEquals(
+                    label,
+                    actual,
+                    readPixels(
+                        mSingleThreadedProcessor.adjustColors(
+                            radian, saturation, table, table, table, identity, 0
+                        )
+                    )
+                )
+            }
+        }
+    }
+}
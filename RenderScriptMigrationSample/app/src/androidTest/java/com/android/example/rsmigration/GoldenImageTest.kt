@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.os.Build
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import java.io.File
+import org.json.JSONObject
+import org.junit.After
+import org.junit.Assert.assertTrue
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check the filters of every backend against the reference implementations of ReferenceFilters,
+// and check that their timings do not regress from the baselines recorded for the device.
+//
+// The baselines are stored in the timing_baselines.json asset, as an object mapping Build.MODEL to
+// an object mapping "<backend>/<filter>" to the median time in milliseconds. The timings without a
+// baseline are recorded to timing_baselines.json in the external files directory of the app, and
+// serve as the baselines of the later runs on the device. The test is skipped rather than passed
+// when any timing had no baseline. To commit the baselines of a device, e.g. the emulator of the
+// CI, pull the recorded file with adb and merge it into the asset.
+@RunWith(AndroidJUnit4::class)
+class GoldenImageTest {
+    companion object {
+        private val TAG = GoldenImageTest::class.java.simpleName
+
+        private val RADIANS = floatArrayOf(-2.0f, 0.5f, 3.0f)
+        private val RADII = floatArrayOf(1.0f, 4.5f, 10.0f, 25.0f)
+
+        // The RenderScript intrinsics compute the color matrix in 8-bit fixed point, and the
+        // RenderScript scripts truncate the results instead of rounding them.
+        private const val MAX_ABS_ERROR = 2
+        private const val MIN_PSNR_DB = 40.0
+
+        // A timing regresses if its median exceeds the baseline by more than MAX_SLOWDOWN times
+        // plus TIMING_SLACK_MS, which absorbs the noise of the shortest filters.
+        private const val TIMING_WARMUP_ITERATIONS = 2
+        private const val TIMING_ITERATIONS = 10
+        private const val MAX_SLOWDOWN = 1.5
+        private const val TIMING_SLACK_MS = 0.5
+
+        private const val BASELINES_ASSET = "timing_baselines.json"
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private class Case(
+        val label: String,
+        val filter: (ImageProcessor) -> Bitmap,
+        val reference: () -> IntArray
+    )
+
+    private lateinit var mInputImage: Bitmap
+    private lateinit var mInputPixels: IntArray
+    private lateinit var mProcessors: List<ImageProcessor>
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        // The reference filters run on the JVM, so the input is downscaled to keep them short.
+        val input = loadTestBitmap(context)
+        mInputImage = Bitmap.createScaledBitmap(input, input.width / 2, input.height / 2, true)
+        mInputPixels = readPixels(mInputImage)
+        mProcessors = listOf(
+            RenderScriptImageProcessor(context, useIntrinsic = true),
+            RenderScriptImageProcessor(context, useIntrinsic = false),
+            VulkanImageProcessor(context),
+            GLSLImageProcessor(),
+            CpuImageProcessor()
+        )
+        for (processor in mProcessors) processor.configureInputAndOutput(mInputImage, 1)
+    }
+
+    @After
+    fun tearDown() {
+        for (processor in mProcessors) processor.cleanup()
+    }
+
+    private fun getCases(): List<Case> {
+        val width = mInputImage.width
+        val height = mInputImage.height
+        return RADIANS.map { radian ->
+            Case(
+                "rotateHue($radian)",
+                { it.rotateHue(radian, 0) },
+                { referenceRotateHue(mInputPixels, radian) }
+            )
+        } + RADII.map { radius ->
+            Case(
+                "blur($radius)",
+                { it.blur(radius, 0) },
+                { referenceBlur(mInputPixels, width, height, radius) }
+            )
+        }
+    }
+
+    @Test
+    fun outputsMatchReference() {
+        val failures = mutableListOf<String>()
+        for (case in getCases()) {
+            val expected = case.reference()
+            for (processor in mProcessors) {
+                val difference = compareImages(expected, readPixels(case.filter(processor)))
+                val result = "${processor.name} ${case.label}: " +
+                        "max_abs_error = ${difference.maxAbsError}, psnr = ${difference.psnr}"
+                Log.i(TAG, result)
+                if (difference.maxAbsError > MAX_ABS_ERROR || difference.psnr < MIN_PSNR_DB) {
+                    failures.add(result)
+                }
+            }
+        }
+        assertTrue(failures.joinToString("\n"), failures.isEmpty())
+    }
+
+    // Return the median time of the filter in milliseconds.
+    private fun measureMedianMs(filter: () -> Unit): Double {
+        repeat(TIMING_WARMUP_ITERATIONS) { filter() }
+        val timesMs = List(TIMING_ITERATIONS) {
+            val start = System.nanoTime()
+            filter()
+            (System.nanoTime() - start) / 1e6
+        }.sorted()
+        return timesMs[timesMs.size / 2]
+    }
+
+    // Return the file of the baselines recorded on the device, in the internal files directory if
+    // the external storage is unavailable.
+    private fun getRecordedBaselinesFile(): File {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        return File(context.getExternalFilesDir(null) ?: context.filesDir, BASELINES_ASSET)
+    }
+
+    // Return the baselines of the device, from the asset merged with the recorded ones.
+    private fun loadBaselines(): JSONObject {
+        val baselines = JSONObject()
+        val recordedFile = getRecordedBaselinesFile()
+        val sources = mutableListOf<String>()
+        if (recordedFile.exists()) sources.add(recordedFile.readText())
+        val assets = InstrumentationRegistry.getInstrumentation().context.assets
+        sources.add(assets.open(BASELINES_ASSET).bufferedReader().use { it.readText() })
+        // The asset comes last, so that its baselines take precedence.
+        for (source in sources) {
+            val device = JSONObject(source).optJSONObject(Build.MODEL) ?: continue
+            for (key in device.keys()) baselines.put(key, device.getDouble(key))
+        }
+        return baselines
+    }
+
+    @Test
+    fun timingsDoNotRegress() {
+        val baselines = loadBaselines()
+        val timings = JSONObject()
+        val regressions = mutableListOf<String>()
+        val recorded = mutableListOf<String>()
+        for (case in getCases()) {
+            for (processor in mProcessors) {
+                val key = "${processor.name}/${case.label}"
+                val medianMs = measureMedianMs { case.filter(processor) }
+                timings.put(key, medianMs)
+                if (!baselines.has(key)) {
+                    recorded.add(key)
+                    baselines.put(key, medianMs)
+                    continue
+                }
+                val baselineMs = baselines.getDouble(key)
+                if (medianMs > baselineMs * MAX_SLOWDOWN + TIMING_SLACK_MS) {
+                    regressions.add("$key: $medianMs ms, baseline $baselineMs ms")
+                }
+            }
+        }
+        Log.i(TAG, "Timings of ${Build.MODEL}: ${JSONObject().put(Build.MODEL, timings)}")
+        val file = getRecordedBaselinesFile()
+        if (recorded.isNotEmpty()) {
+            file.writeText(JSONObject().put(Build.MODEL, baselines).toString(2))
+            Log.w(TAG, "Recorded ${recorded.size} new timing baselines to ${file.path}: $recorded")
+        }
+        assertTrue(regressions.joinToString("\n"), regressions.isEmpty())
+        // A run comparing only part of the timings must not look like a pass.
+        assumeTrue(
+            "No timing baselines of ${Build.MODEL} for $recorded, recorded to ${file.path}",
+            recorded.isEmpty()
+        )
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
+import android.graphics.Color
+import kotlin.math.abs
+import kotlin.math.log10
+import kotlin.math.max
+
+// The difference between two images over the RGB channels. The alpha channel is ignored because
+// all the filters write opaque pixels.
+data class ImageDifference(val maxAbsError: Int, val psnr: Double)
+
+// Load the sample image used by MainActivity as the test input.
+fun loadTestBitmap(context: Context): Bitmap {
+    val options = BitmapFactory.Options()
+    options.inPreferredConfig = Bitmap.Config.ARGB_8888
+    options.inScaled = false
+    return BitmapFactory.decodeResource(context.resources, R.drawable.data, options)
+        ?: throw RuntimeException("Unable to load bitmap.")
+}
+
+// Read back the pixels of a bitmap. Hardware bitmaps, such as the outputs of the Vulkan image
+// processor, are copied to a software bitmap first.
+fun readPixels(bitmap: Bitmap): IntArray {
+    val softwareBitmap = if (bitmap.config == Bitmap.Config.HARDWARE) {
+        bitmap.copy(Bitmap.Config.ARGB_8888, false)
+    } else {
+        bitmap
+    }
+    val pixels = IntArray(softwareBitmap.width * softwareBitmap.height)
+    softwareBitmap.getPixels(
+        pixels, 0, softwareBitmap.width, 0, 0, softwareBitmap.width, softwareBitmap.height
+    )
+    return pixels
+}
+
+// Compute the maximum absolute error and the PSNR in dB of actual against expected.
+fun compareImages(expected: IntArray, actual: IntArray): ImageDifference {
+    if (expected.size != actual.size) throw IllegalArgumentException("Image sizes do not match")
+    var maxAbsError = 0
+    var sumSquaredError = 0.0
+    for (i in expected.indices) {
+        val errors = intArrayOf(
+            Color.red(expected[i]) - Color.red(actual[i]),
+            Color.green(expected[i]) - Color.green(actual[i]),
+            Color.blue(expected[i]) - Color.blue(actual[i])
+        )
+        for (error in errors) {
+            maxAbsError = max(maxAbsError, abs(error))
+            sumSquaredError += (error * error).toDouble()
+        }
+    }
+    val meanSquaredError = sumSquaredError / (expected.size * 3)
+    val psnr = if (meanSquaredError == 0.0) {
+        Double.POSITIVE_INFINITY
+    } else {
+        10.0 * log10(255.0 * 255.0 / meanSquaredError)
+    }
+    return ImageDifference(maxAbsError, psnr)
+}
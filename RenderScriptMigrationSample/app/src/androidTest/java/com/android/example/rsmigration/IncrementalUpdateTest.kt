@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.graphics.Canvas
+import android.graphics.Color
+import android.graphics.Paint
+import android.graphics.Rect
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check that updating a rect of the Vulkan input image and filtering the damaged region only
+// produces the same output as filtering the edited image from scratch.
+@RunWith(AndroidJUnit4::class)
+class IncrementalUpdateTest {
+    companion object {
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mInput: Bitmap
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mInput = loadTestBitmap(context).copy(Bitmap.Config.ARGB_8888, true)
+        mProcessor = VulkanImageProcessor(context)
+        mProcessor.configureInputAndOutput(mInput, 1)
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    // Paint a stroke over the rect of the input bitmap.
+    private fun paintStroke(rect: Rect) {
+        val paint = Paint().apply { color = Color.rgb(255, 64, 0) }
+        Canvas(mInput).drawRect(rect, paint)
+    }
+
+    // Filter the input bitmap from scratch with a separate processor.
+    private fun filterFromScratch(filter: (VulkanImageProcessor) -> Bitmap): IntArray {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val processor = VulkanImageProcessor(context)
+        try {
+            processor.configureInputAndOutput(mInput, 1)
+            return readPixels(filter(processor))
+        } finally {
+            processor.cleanup()
+        }
+    }
+
+    private fun checkIncremental(
+        filter: (VulkanImageProcessor) -> Bitmap,
+        damagedFilter: (VulkanImageProcessor, Rect) -> Bitmap
+    ) {
+        filter(mProcessor)
+        val width = mInput.width
+        val height = mInput.height
+        // One stroke within the image, and one crossing its bottom right corner.
+        val strokes = listOf(
+            Rect(width / 3, height / 4, width / 3 + 40, height / 4 + 25),
+            Rect(width - 10, height - 20, width + 20, height + 10)
+        )
+        for (damage in strokes) {
+            paintStroke(damage)
+            val clipped = Rect(damage)
+            clipped.intersect(0, 0, width, height)
+            mProcessor.updateInput(mInput, clipped)
+            val actual = readPixels(damagedFilter(mProcessor, damage))
+            assertArrayEquals("Damage $damage", filterFromScratch(filter), actual)
+        }
+    }
+
+    @Test
+    fun rotateHueMatchesFullUpdate() {
+        checkIncremental({ it.rotateHue(1.0f, 0) }, { p, damage -> p.rotateHue(1.0f, 0, damage) })
+    }
+
+    @Test
+    fun saturationMatchesFullUpdate() {
+        checkIncremental({ it.saturation(0.3f, 0) }, { p, damage -> p.saturation(0.3f, 0, damage) })
+    }
+
+    @Test
+    fun blurMatchesFullUpdate() {
+        checkIncremental({ it.blur(20.0f, 0) }, { p, damage -> p.blur(20.0f, 0, damage) })
+    }
+
+    @Test
+    fun damageOutsideOfImageKeepsOutput() {
+        val expected = readPixels(mProcessor.blur(5.0f, 0))
+        val outside = Rect(mInput.width + 100, 0, mInput.width + 110, 10)
+        assertArrayEquals(expected, readPixels(mProcessor.blur(5.0f, 0, outside)))
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Report the deviation of the Vulkan pyramid blur from the Vulkan gaussian blur with the same
+// radius, at different quality settings.
+@RunWith(AndroidJUnit4::class)
+class PyramidBlurTest {
+    companion object {
+        private val TAG = PyramidBlurTest::class.java.simpleName
+
+        // The gaussian blur only supports radii up to 25.
+        private val RADII = floatArrayOf(4.0f, 10.0f, 25.0f)
+        private val QUALITIES = floatArrayOf(0.0f, 0.5f, 1.0f)
+
+        // The minimum PSNR for the pyramid blur to be considered a gaussian approximation.
+        private const val MIN_PSNR_DB = 25.0
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mProcessor = VulkanImageProcessor(context)
+        mProcessor.configureInputAndOutput(loadTestBitmap(context), 2)
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    @Test
+    fun pyramidBlurApproximatesGaussian() {
+        for (radius in RADII) {
+            val expected = readPixels(mProcessor.blur(radius, 0))
+            for (quality in QUALITIES) {
+                val actual = readPixels(mProcessor.pyramidBlur(radius, quality, 1))
+                val difference = compareImages(expected, actual)
+                Log.i(
+                    TAG, "Pyramid blur deviation: radius = ${radius}, quality = ${quality}, " +
+                            "max_abs_error = ${difference.maxAbsError}, psnr = ${difference.psnr}"
+                )
+                assertTrue(
+                    "PSNR ${difference.psnr} dB at radius $radius, quality $quality",
+                    difference.psnr >= MIN_PSNR_DB
+                )
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check that the asynchronous readback of the Vulkan output images matches the pixels read from
+// the hardware bitmaps.
+@RunWith(AndroidJUnit4::class)
+class ReadbackTest {
+    companion object {
+        private const val NUM_OUTPUTS = 2
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mProcessor = VulkanImageProcessor(context)
+        mProcessor.configureInputAndOutput(loadTestBitmap(context), NUM_OUTPUTS)
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    @Test
+    fun readbackMatchesOutput() {
+        val expected = readPixels(mProcessor.blur(10.0f, 0))
+        val actual = readPixels(mProcessor.readback(0).get())
+        assertArrayEquals(expected, actual)
+    }
+
+    @Test
+    fun overlappingReadbacksMatchOutputs() {
+        // Keep more readbacks in flight than there are readback buffers, and only consume the
+        // results afterwards.
+        val radii = floatArrayOf(2.0f, 5.0f, 10.0f, 20.0f)
+        val expected = radii.mapIndexed { i, radius ->
+            readPixels(mProcessor.blur(radius, i % NUM_OUTPUTS))
+        }
+        val readbacks = radii.mapIndexed { i, radius ->
+            mProcessor.blur(radius, i % NUM_OUTPUTS)
+            mProcessor.readback(i % NUM_OUTPUTS)
+        }
+        for (i in radii.indices) {
+            assertArrayEquals("Readback $i", expected[i], readPixels(readbacks[i].get()))
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Color
+import kotlin.math.ceil
+import kotlin.math.cos
+import kotlin.math.exp
+import kotlin.math.roundToInt
+import kotlin.math.sin
+import kotlin.math.sqrt
+
+// Reference implementations of the filters of ImageProcessor, following colormatrix.rs and blur.rs
+// in double precision, and rounding the results to the nearest. The pixels are ARGB colors as
+// returned by readPixels, and the results are opaque.
+
+private fun toChannel(value: Double): Int = value.roundToInt().coerceIn(0, 255)
+
+// Apply the hue rotation by radian, with the matrix of RenderScriptImageProcessor.rotateHue.
+fun referenceRotateHue(pixels: IntArray, radian: Float): IntArray {
+    val cos = cos(radian.toDouble())
+    val sin = sin(radian.toDouble())
+    // The row c holds the weights of the input channels for the output channel c.
+    val matrix = arrayOf(
+        doubleArrayOf(.299 + .701 * cos + .168 * sin, .587 - .587 * cos + .330 * sin,
+            .114 - .114 * cos - .497 * sin),
+        doubleArrayOf(.299 - .299 * cos - .328 * sin, .587 + .413 * cos + .035 * sin,
+            .114 - .114 * cos + .292 * sin),
+        doubleArrayOf(.299 - .300 * cos + 1.25 * sin, .587 - .588 * cos - 1.05 * sin,
+            .114 + .886 * cos - .203 * sin)
+    )
+    return IntArray(pixels.size) { i ->
+        val rgb = doubleArrayOf(
+            Color.red(pixels[i]).toDouble(),
+            Color.green(pixels[i]).toDouble(),
+            Color.blue(pixels[i]).toDouble()
+        )
+        val result = matrix.map { row ->
+            toChannel(row[0] * rgb[0] + row[1] * rgb[1] + row[2] * rgb[2])
+        }
+        Color.argb(255, result[0], result[1], result[2])
+    }
+}
+
+// Mix each pixel with its luminance by the saturation, following saturation.rs.
+fun referenceSaturation(pixels: IntArray, saturation: Float): IntArray {
+    return IntArray(pixels.size) { i ->
+        val rgb = intArrayOf(Color.red(pixels[i]), Color.green(pixels[i]), Color.blue(pixels[i]))
+        val luminance = .299 * rgb[0] + .587 * rgb[1] + .114 * rgb[2]
+        val result = rgb.map { toChannel(luminance + (it - luminance) * saturation) }
+        Color.argb(255, result[0], result[1], result[2])
+    }
+}
+
+// Map each color channel through its lookup table of 256 entries, like ScriptIntrinsicLUT.
+fun referenceLut(pixels: IntArray, red: ByteArray, green: ByteArray, blue: ByteArray): IntArray {
+    return IntArray(pixels.size) { i ->
+        Color.argb(
+            255,
+            red[Color.red(pixels[i])].toInt() and 0xff,
+            green[Color.green(pixels[i])].toInt() and 0xff,
+            blue[Color.blue(pixels[i])].toInt() and 0xff
+        )
+    }
+}
+
+// Apply the separable gaussian blur of the radius, with the kernel of ComputeGaussianWeights and
+// clamping to edge.
+fun referenceBlur(pixels: IntArray, width: Int, height: Int, radius: Float): IntArray {
+    val sigma = 0.4 * radius + 0.6
+    val iRadius = ceil(radius).toInt()
+    val weights = DoubleArray(2 * iRadius + 1) { i ->
+        val r = (i - iRadius).toDouble()
+        exp(-r * r / (2 * sigma * sigma)) / (sqrt(2 * Math.PI) * sigma)
+    }
+    val sum = weights.sum()
+    val kernel = weights.map { it / sum }
+
+    val channels = arrayOf<(Int) -> Int>(Color::red, Color::green, Color::blue)
+    val horizontal = Array(3) { DoubleArray(width * height) }
+    for (y in 0 until height) {
+        for (x in 0 until width) {
+            for (c in 0 until 3) {
+                var value = 0.0
+                for (k in kernel.indices) {
+                    val sx = (x + k - iRadius).coerceIn(0, width - 1)
+                    value += kernel[k] * channels[c](pixels[y * width + sx])
+                }
+                horizontal[c][y * width + x] = value
+            }
+        }
+    }
+    return IntArray(width * height) { i ->
+        val x = i % width
+        val y = i / width
+        val result = IntArray(3) { c ->
+            var value = 0.0
+            for (k in kernel.indices) {
+                val sy = (y + k - iRadius).coerceIn(0, height - 1)
+                value += kernel[k] * horizontal[c][sy * width + x]
+            }
+            toChannel(value)
+        }
+        Color.argb(255, result[0], result[1], result[2])
+    }
+}
+
+// Apply the box blur of the radius, i.e. the mean of the (2 * ceil(radius) + 1)^2 pixels around
+// each pixel, clamping to edge.
+fun referenceBoxBlur(pixels: IntArray, width: Int, height: Int, radius: Float): IntArray {
+    val iRadius = ceil(radius).toInt()
+    val size = 2 * iRadius + 1
+    val channels = arrayOf<(Int) -> Int>(Color::red, Color::green, Color::blue)
+    val horizontal = Array(3) { DoubleArray(width * height) }
+    for (y in 0 until height) {
+        for (x in 0 until width) {
+            for (c in 0 until 3) {
+                var sum = 0.0
+                for (k in -iRadius..iRadius) {
+                    val sx = (x + k).coerceIn(0, width - 1)
+                    sum += channels[c](pixels[y * width + sx])
+                }
+                horizontal[c][y * width + x] = sum / size
+            }
+        }
+    }
+    return IntArray(width * height) { i ->
+        val x = i % width
+        val y = i / width
+        val result = IntArray(3) { c ->
+            var sum = 0.0
+            for (k in -iRadius..iRadius) {
+                val sy = (y + k).coerceIn(0, height - 1)
+                sum += horizontal[c][sy * width + x]
+            }
+            toChannel(sum / size)
+        }
+        Color.argb(255, result[0], result[1], result[2])
+    }
+}
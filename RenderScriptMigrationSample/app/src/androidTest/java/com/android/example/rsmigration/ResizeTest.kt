@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.renderscript.Allocation
+import android.renderscript.RenderScript
+import android.renderscript.ScriptIntrinsicResize
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check the Vulkan bicubic resize of the input image against ScriptIntrinsicResize.
+@RunWith(AndroidJUnit4::class)
+class ResizeTest {
+    companion object {
+        private val TAG = ResizeTest::class.java.simpleName
+
+        // Both resize with the same cubic filter when upsizing. The Vulkan resize keeps a half
+        // float intermediate image between the two passes.
+        private const val MIN_PSNR_DB = 40.0
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    // Read back the input image of the processor through an identity LUT.
+    private fun readInputImage(processor: VulkanImageProcessor): IntArray {
+        val identity = ByteArray(256) { v -> v.toByte() }
+        return readPixels(processor.lut(identity, identity, identity, identity, 0))
+    }
+
+    @Test
+    fun bicubicUpsizeMatchesRenderScript() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val inputImage = loadTestBitmap(context)
+        val width = inputImage.width * 3 / 2
+        val height = inputImage.height * 3 / 2
+
+        // Resize with RenderScript
+        val rs = RenderScript.create(context)
+        val expectedImage = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
+        val inputAllocation = Allocation.createFromBitmap(rs, inputImage)
+        val outputAllocation = Allocation.createFromBitmap(rs, expectedImage)
+        val resize = ScriptIntrinsicResize.create(rs)
+        resize.setInput(inputAllocation)
+        resize.forEach_bicubic(outputAllocation)
+        outputAllocation.copyTo(expectedImage)
+        rs.destroy()
+
+        // Resize with Vulkan
+        val processor = VulkanImageProcessor(context)
+        processor.configureInputAndOutput(
+            inputImage, 1, width, height, VulkanImageProcessor.ResizeFilter.BICUBIC
+        )
+        val actual = readInputImage(processor)
+        processor.cleanup()
+
+        val difference = compareImages(readPixels(expectedImage), actual)
+        Log.i(
+            TAG, "Resize deviation: max_abs_error = ${difference.maxAbsError}, " +
+                    "psnr = ${difference.psnr}"
+        )
+        assertTrue("PSNR ${difference.psnr} dB", difference.psnr >= MIN_PSNR_DB)
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+import android.graphics.Canvas
+import android.graphics.Color
+import android.graphics.Rect
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+// Check that the results served by the Vulkan result cache match the filters computed with the
+// quantized parameters, and that the cache stays within its budget.
+@RunWith(AndroidJUnit4::class)
+class ResultCacheTest {
+    companion object {
+        private const val STEP = 0.01f
+
+        init {
+            System.loadLibrary("rs_migration_jni")
+        }
+    }
+
+    private lateinit var mInput: Bitmap
+    private lateinit var mProcessor: VulkanImageProcessor
+
+    @Before
+    fun setUp() {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        mInput = loadTestBitmap(context).copy(Bitmap.Config.ARGB_8888, true)
+        mProcessor = createProcessor()
+    }
+
+    @After
+    fun tearDown() {
+        mProcessor.cleanup()
+    }
+
+    private fun imageSize(): Long = mInput.width.toLong() * mInput.height * 4
+
+    // Create a processor caching up to four results of the input image.
+    private fun createProcessor(): VulkanImageProcessor {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        val processor = VulkanImageProcessor(context)
+        processor.configureInputAndOutput(mInput, 2)
+        processor.setResultCache(4 * imageSize(), STEP)
+        return processor
+    }
+
+    @Test
+    fun hitMatchesMiss() {
+        val miss = readPixels(mProcessor.blur(10.0f, 0))
+        val hit = readPixels(mProcessor.blur(10.0f, 1))
+        assertArrayEquals(miss, hit)
+    }
+
+    @Test
+    fun nearbyParametersShareResult() {
+        val expected = readPixels(mProcessor.rotateHue(1.0f, 0))
+        // Within the same step, the cached result is copied as is.
+        assertArrayEquals(expected, readPixels(mProcessor.rotateHue(1.004f, 1)))
+        assertArrayEquals(expected, readPixels(mProcessor.rotateHue(0.996f, 1)))
+        // The next step computes a new result.
+        val next = readPixels(mProcessor.rotateHue(1.5f, 1))
+        assertFalse(expected.contentEquals(next))
+    }
+
+    @Test
+    fun memoryStaysWithinBudget() {
+        mProcessor.setResultCache(0, STEP)
+        mProcessor.saturation(0.5f, 0)
+        val baseline = mProcessor.getMemoryUsage()
+        val budget = 2 * imageSize() + imageSize() / 2
+        mProcessor.setResultCache(budget, STEP)
+        for (i in 1..5) {
+            mProcessor.saturation(i * 0.1f, 0)
+            assertTrue(mProcessor.getMemoryUsage() - baseline <= budget)
+        }
+        // The least recently used results have been evicted, and the latest one is served again.
+        val latest = readPixels(mProcessor.getOutputImage(0))
+        assertArrayEquals(latest, readPixels(mProcessor.saturation(0.5f, 1)))
+    }
+
+    @Test
+    fun updateInputInvalidatesResults() {
+        mProcessor.blur(5.0f, 0)
+        Canvas(mInput).drawColor(Color.BLUE)
+        mProcessor.updateInput(mInput, Rect(0, 0, mInput.width, mInput.height))
+        val actual = readPixels(mProcessor.blur(5.0f, 0))
+
+        // Compare against a processor configured with the updated input.
+        val processor = createProcessor()
+        try {
+            assertArrayEquals(readPixels(processor.blur(5.0f, 0)), actual)
+        } finally {
+            processor.cleanup()
+        }
+    }
+}
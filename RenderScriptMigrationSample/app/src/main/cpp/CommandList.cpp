@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CommandList.h"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "Utils.h"
+
+namespace sample {
+namespace {
+
+constexpr size_t kWordSize = 4;
+constexpr size_t kMaxParameters = 2;
+
+struct Command {
+    CommandOpcode opcode;
+    int32_t outputIndex;
+    std::array<float, kMaxParameters> parameters;
+    // Whether the command was decoded successfully.
+    bool isValid;
+};
+
+// Return the number of float parameters of the opcode, or -1 if the opcode is unknown.
+int getNumParameters(uint32_t opcode) {
+    switch (static_cast<CommandOpcode>(opcode)) {
+        case CommandOpcode::kRotateHue:
+        case CommandOpcode::kBlur:
+        case CommandOpcode::kBoxBlur:
+        case CommandOpcode::kStackedBoxBlur:
+            return 1;
+        case CommandOpcode::kPyramidBlur:
+            return 2;
+        case CommandOpcode::kWaitForCompletion:
+            return 0;
+    }
+    return -1;
+}
+
+// Whether the output index of the command is kWindowOutput or one of the numOutputImages output
+// images. The output index of CommandOpcode::kWaitForCompletion is ignored.
+bool isValidOutputIndex(const Command& command, int numOutputImages) {
+    if (command.opcode == CommandOpcode::kWaitForCompletion) return true;
+    return command.outputIndex == ImageProcessor::kWindowOutput ||
+           (0 <= command.outputIndex && command.outputIndex < numOutputImages);
+}
+
+// Decode the commands. An invalid command ends the list.
+std::vector<Command> decode(const uint8_t* data, size_t size, int numOutputImages) {
+    std::vector<Command> commands;
+    size_t offset = 0;
+    const auto readWord = [data, size, &offset](void* word) {
+        if (size - offset < kWordSize) return false;
+        memcpy(word, data + offset, kWordSize);
+        offset += kWordSize;
+        return true;
+    };
+    while (offset < size) {
+        Command command = {};
+        uint32_t opcode = 0;
+        command.isValid = readWord(&opcode) && readWord(&command.outputIndex);
+        const int numParameters = getNumParameters(opcode);
+        command.isValid = command.isValid && numParameters >= 0;
+        for (int i = 0; command.isValid && i < numParameters; i++) {
+            command.isValid = readWord(&command.parameters[static_cast<size_t>(i)]);
+        }
+        command.opcode = static_cast<CommandOpcode>(opcode);
+        command.isValid = command.isValid && isValidOutputIndex(command, numOutputImages);
+        commands.push_back(command);
+        if (!command.isValid) {
+            LOGE("Invalid command %zu with opcode %u", commands.size() - 1, opcode);
+            break;
+        }
+    }
+    return commands;
+}
+
+bool execute(ImageProcessor* processor, const Command& command) {
+    const auto& p = command.parameters;
+    switch (command.opcode) {
+        case CommandOpcode::kRotateHue:
+            return processor->rotateHue(p[0], command.outputIndex);
+        case CommandOpcode::kBlur:
+            return processor->blur(p[0], command.outputIndex);
+        case CommandOpcode::kBoxBlur:
+            return processor->boxBlur(p[0], command.outputIndex);
+        case CommandOpcode::kStackedBoxBlur:
+            return processor->stackedBoxBlur(p[0], command.outputIndex);
+        case CommandOpcode::kPyramidBlur:
+            return processor->pyramidBlur(p[0], p[1], command.outputIndex);
+        case CommandOpcode::kWaitForCompletion:
+            return processor->waitForCompletion();
+    }
+    return false;
+}
+
+}  // namespace
+
+int executeCommandList(ImageProcessor* processor, const uint8_t* commands, size_t commandsSize,
+                       uint8_t* results, size_t resultsSize) {
+    const std::vector<Command> decoded =
+            decode(commands, commandsSize, processor->numOutputImages());
+    if (decoded.size() * kCommandResultSize > resultsSize) {
+        LOGE("The results of %zu commands do not fit in %zu bytes", decoded.size(), resultsSize);
+        return -1;
+    }
+
+    for (size_t i = 0; i < decoded.size(); i++) {
+        CommandStatus status = CommandStatus::kInvalid;
+        int64_t elapsedNanos = 0;
+        if (decoded[i].isValid) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool success = execute(processor, decoded[i]);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            status = success ? CommandStatus::kSuccess : CommandStatus::kFailed;
+        }
+        uint8_t* result = results + i * kCommandResultSize;
+        memset(result, 0, kCommandResultSize);
+        memcpy(result, &status, sizeof(status));
+        memcpy(result + 8, &elapsedNanos, sizeof(elapsedNanos));
+    }
+    return static_cast<int>(decoded.size());
+}
+
+}  // namespace sample
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_COMMAND_LIST_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_COMMAND_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ImageProcessor.h"
+
+namespace sample {
+
+// A command list batches the filters of an ImageProcessor into one call, e.g. to cross JNI once
+// per frame. The commands and the results are packed in native byte order, matching the Kotlin
+// VulkanCommandList.
+//
+// Each command is a sequence of 4-byte words: the CommandOpcode, the output index, and the float
+// parameters of the opcode. Each result is kCommandResultSize bytes: the int32 CommandStatus, 4
+// bytes of padding, and the int64 elapsed time of the command in nanoseconds. The time is measured
+// on the host, so it covers recording and submitting the filter, and only includes the device time
+// for CommandOpcode::kWaitForCompletion.
+
+// The parameters of each opcode are listed in the comments. Must match VulkanCommandList.
+enum class CommandOpcode : uint32_t {
+    kRotateHue = 0,          // radian
+    kBlur = 1,               // radius
+    kBoxBlur = 2,            // radius
+    kStackedBoxBlur = 3,     // radius
+    kPyramidBlur = 4,        // radius, quality
+    kWaitForCompletion = 5,  // none, the output index is ignored
+};
+
+enum class CommandStatus : int32_t {
+    kSuccess = 0,
+    // The filter returned false. The following commands are still executed.
+    kFailed = 1,
+    // The command could not be decoded, e.g. an unknown opcode, an output index out of range or a
+    // truncated command. It is the last result, the following bytes are ignored.
+    kInvalid = 2,
+};
+
+constexpr size_t kCommandResultSize = 16;
+
+// Decode the command list and execute the commands in order, writing one result per command to
+// results, which holds resultsSize bytes. Return the number of results, or -1 without executing
+// any command if the results do not fit.
+int executeCommandList(ImageProcessor* processor, const uint8_t* commands, size_t commandsSize,
+                       uint8_t* results, size_t resultsSize);
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_COMMAND_LIST_H
@@ -59,21 +59,57 @@ std::unique_ptr<ComputePipeline> ComputePipeline::create(const VulkanContext* co
                                                          const char* shader,
                                                          AAssetManager* assetManager,
                                                          uint32_t pushConstantSize,
-                                                         bool useUniformBuffer) {
+                                                         bool useUniformBuffer,
+                                                         uint32_t numDescriptorSets,
+                                                         VkFilter inputFilter) {
     auto pipeline = std::make_unique<ComputePipeline>(context, pushConstantSize);
-    const bool success = pipeline->createDescriptorSet(useUniformBuffer) &&
+    bool success = true;
+    // The image samplers are nearest, a pipeline only needs its own sampler for linear filtering.
+    if (inputFilter != VK_FILTER_NEAREST) {
+        success = pipeline->createInputSampler(inputFilter);
+    }
+    success = success && pipeline->createDescriptorSets(useUniformBuffer, numDescriptorSets) &&
                          pipeline->createComputePipeline(shader, assetManager);
     return success ? std::move(pipeline) : nullptr;
 }
 
-bool ComputePipeline::createDescriptorSet(bool useUniformBuffer) {
-    // Create descriptor set layout
+bool ComputePipeline::createInputSampler(VkFilter filter) {
+    const VkSamplerCreateInfo samplerCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .pNext = nullptr,
+            .magFilter = filter,
+            .minFilter = filter,
+            .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .mipLodBias = 0.0f,
+            .anisotropyEnable = VK_FALSE,
+            .maxAnisotropy = 1,
+            .compareEnable = VK_FALSE,
+            .compareOp = VK_COMPARE_OP_NEVER,
+            .minLod = 0.0f,
+            .maxLod = 0.0f,
+            .borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+            // Use unnormalized coordinates to be consistent with the samplers of the images
+            .unnormalizedCoordinates = VK_TRUE,
+    };
+    CALL_VK(vkCreateSampler, mContext->device(), &samplerCreateInfo, nullptr,
+            mInputSampler.pHandle());
+    return true;
+}
+
+bool ComputePipeline::createDescriptorSets(bool useUniformBuffer, uint32_t numDescriptorSets) {
     std::vector<VkDescriptorSetLayoutBinding> descriptorsetLayoutBinding = {
             {
                     .binding = 0,  // input image
                     .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                     .descriptorCount = 1,
                     .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                    // The immutable sampler overrides the sampler of the input image.
+                    .pImmutableSamplers = mInputSampler.handle() != VK_NULL_HANDLE
+                                                  ? mInputSampler.pHandle()
+                                                  : nullptr,
             },
             {
                     .binding = 1,  // output image
@@ -91,6 +127,17 @@ bool ComputePipeline::createDescriptorSet(bool useUniformBuffer) {
                 .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
         });
     }
+    return createDescriptorSets(descriptorsetLayoutBinding, numDescriptorSets);
+}
+
+bool ComputePipeline::createDescriptorSets(
+        const std::vector<VkDescriptorSetLayoutBinding>& descriptorsetLayoutBinding,
+        uint32_t numDescriptorSets) {
+    RET_CHECK(numDescriptorSets > 0);
+    mNumDescriptorSetsPerFrame = numDescriptorSets;
+    const uint32_t numSets = numDescriptorSets * kMaxFramesInFlight;
+
+    // Create descriptor set layout
     const VkDescriptorSetLayoutCreateInfo descriptorsetLayoutDesc = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
             .bindingCount = static_cast<uint32_t>(descriptorsetLayoutBinding.size()),
@@ -99,26 +146,46 @@ bool ComputePipeline::createDescriptorSet(bool useUniformBuffer) {
     CALL_VK(vkCreateDescriptorSetLayout, mContext->device(), &descriptorsetLayoutDesc, nullptr,
             mDescriptorSetLayout.pHandle());
 
-    // Allocate descriptor set
+    // Create a descriptor pool that fits exactly the descriptor sets of this pipeline. The pool
+    // sizes of the same descriptor type add up.
+    std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
+    for (const auto& binding : descriptorsetLayoutBinding) {
+        descriptorPoolSizes.push_back({
+                .type = binding.descriptorType,
+                .descriptorCount = binding.descriptorCount * numSets,
+        });
+    }
+    const VkDescriptorPoolCreateInfo descriptorPoolDesc = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = numSets,
+            .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
+            .pPoolSizes = descriptorPoolSizes.data(),
+    };
+    CALL_VK(vkCreateDescriptorPool, mContext->device(), &descriptorPoolDesc, nullptr,
+            mDescriptorPool.pHandle());
+
+    // Allocate descriptor sets, all of them share the same layout
+    const std::vector<VkDescriptorSetLayout> setLayouts(numSets, mDescriptorSetLayout.handle());
     const VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool = mContext->descriptorPool(),
-            .descriptorSetCount = 1,
-            .pSetLayouts = mDescriptorSetLayout.pHandle(),
+            .descriptorPool = mDescriptorPool.handle(),
+            .descriptorSetCount = numSets,
+            .pSetLayouts = setLayouts.data(),
     };
+    mDescriptorSets.resize(numSets);
     CALL_VK(vkAllocateDescriptorSets, mContext->device(), &descriptorSetAllocateInfo,
-            &mDescriptorSet);
+            mDescriptorSets.data());
     return true;
 }
 
-bool ComputePipeline::updateDescriptorSets(const Image& inputImage, const Image& outputImage,
-                                           const Buffer* uniformBuffer) {
+bool ComputePipeline::updateDescriptorSet(VkDescriptorSet descriptorSet, const Image& inputImage,
+                                          const Image& outputImage, const Buffer* uniformBuffer) {
     const auto inputImageInfo = inputImage.getDescriptor();
     const auto outputImageInfo = outputImage.getDescriptor();
     std::vector<VkWriteDescriptorSet> writeDescriptorSet = {
             {
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = mDescriptorSet,
+                    .dstSet = descriptorSet,
                     .dstBinding = 0,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
@@ -129,7 +196,7 @@ bool ComputePipeline::updateDescriptorSets(const Image& inputImage, const Image&
             },
             {
                     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .dstSet = mDescriptorSet,
+                    .dstSet = descriptorSet,
                     .dstBinding = 1,
                     .dstArrayElement = 0,
                     .descriptorCount = 1,
@@ -144,7 +211,7 @@ bool ComputePipeline::updateDescriptorSets(const Image& inputImage, const Image&
         uboInfo = uniformBuffer->getDescriptor();
         writeDescriptorSet.push_back({
                 .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = mDescriptorSet,
+                .dstSet = descriptorSet,
                 .dstBinding = 2,
                 .dstArrayElement = 0,
                 .descriptorCount = 1,
@@ -218,20 +285,35 @@ bool ComputePipeline::createComputePipeline(const char* shader, AAssetManager* a
 void ComputePipeline::recordComputeCommands(VkCommandBuffer cmd, const void* pushConstantData,
                                             const Image& inputImage, const Image& outputImage,
                                             const Buffer* uniformBuffer) {
+    recordComputeCommands(cmd, pushConstantData, inputImage, outputImage, uniformBuffer,
+                          /*descriptorSetIndex=*/0, {outputImage.width(), outputImage.height()});
+}
+
+void ComputePipeline::recordComputeCommands(VkCommandBuffer cmd, const void* pushConstantData,
+                                            const Image& inputImage, const Image& outputImage,
+                                            const Buffer* uniformBuffer,
+                                            uint32_t descriptorSetIndex,
+                                            VkExtent2D dispatchExtent) {
     // Update descriptor sets with input and output images
-    updateDescriptorSets(inputImage, outputImage, uniformBuffer);
+    updateDescriptorSet(getDescriptorSet(descriptorSetIndex), inputImage, outputImage,
+                        uniformBuffer);
+    recordDispatch(cmd, pushConstantData, descriptorSetIndex, dispatchExtent);
+}
 
+void ComputePipeline::recordDispatch(VkCommandBuffer cmd, const void* pushConstantData,
+                                     uint32_t descriptorSetIndex, VkExtent2D dispatchExtent) {
     // Record compute pipeline
+    const VkDescriptorSet descriptorSet = getDescriptorSet(descriptorSetIndex);
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline.handle());
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout.handle(), 0, 1,
-                            &mDescriptorSet, 0, nullptr);
+                            &descriptorSet, 0, nullptr);
     if (pushConstantData != nullptr && mPushConstantSize > 0) {
         vkCmdPushConstants(cmd, mPipelineLayout.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
                            mPushConstantSize, pushConstantData);
     }
     const auto workGroupSize = mContext->getWorkGroupSize();
-    const uint32_t groupCountX = ceilOfDiv(outputImage.width(), workGroupSize);
-    const uint32_t groupCountY = ceilOfDiv(outputImage.height(), workGroupSize);
+    const uint32_t groupCountX = ceilOfDiv(dispatchExtent.width, workGroupSize);
+    const uint32_t groupCountY = ceilOfDiv(dispatchExtent.height, workGroupSize);
     vkCmdDispatch(cmd, groupCountX, groupCountY, 1);
 }
 
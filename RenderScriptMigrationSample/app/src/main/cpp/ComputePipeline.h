@@ -22,29 +22,43 @@
 
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include "VulkanContext.h"
 #include "VulkanResources.h"
 
 namespace sample {
 
+// The number of command buffers of an ImageProcessor that may be pending at the same time. Each
+// pipeline keeps one copy of its descriptor sets per frame, so that the descriptor sets used by a
+// pending command buffer are never updated, see ComputePipeline::setFrame.
+constexpr uint32_t kMaxFramesInFlight = 2;
+
 // ComputePipeline manages the Vulkan objects for a single compute task with a compute shader.
 // In this sample app, the compute shaders always take 2D images as the input and output, with
 // runtime parameters passed by an uniform buffer. The image and buffer resources are managed
-// outside of this class.
+// outside of this class. Pipelines binding other resources derive from this class with their own
+// descriptor set layouts.
 class ComputePipeline {
    public:
-    // Create a compute pipeline with the input shader.
+    // Create a compute pipeline with the input shader. A pipeline that is recorded more than once
+    // within a single command buffer with different images needs one descriptor set per dispatch,
+    // specified by numDescriptorSets. The input image is sampled with the sampler of the image,
+    // unless inputFilter is VK_FILTER_LINEAR, in which case the pipeline samples the input image
+    // with its own bilinear sampler.
     // Return the created ComputePipeline on success, or nullptr if failed.
     static std::unique_ptr<ComputePipeline> create(const VulkanContext* context, const char* shader,
                                                    AAssetManager* assetManager,
-                                                   uint32_t pushConstantSize,
-                                                   bool useUniformBuffer);
+                                                   uint32_t pushConstantSize, bool useUniformBuffer,
+                                                   uint32_t numDescriptorSets = 1,
+                                                   VkFilter inputFilter = VK_FILTER_NEAREST);
 
     // Prefer ComputePipeline::create
     ComputePipeline(const VulkanContext* context, uint32_t pushConstantSize)
         : mContext(context),
+          mInputSampler(context->device()),
           mDescriptorSetLayout(context->device()),
+          mDescriptorPool(context->device()),
           mPipelineLayout(context->device()),
           mPipeline(context->device()),
           mPushConstantSize(pushConstantSize) {}
@@ -55,22 +69,57 @@ class ComputePipeline {
                                const Image& inputImage, const Image& outputImage,
                                const Buffer* uniformBuffer = nullptr);
 
+    // Select the copy of the descriptor sets used by the following recordComputeCommands calls,
+    // within [0, kMaxFramesInFlight). The descriptor sets of a frame must not be recorded again
+    // before the command buffer of their previous recording has finished.
+    void setFrame(uint32_t frame) { mFrame = frame; }
+
+    // Same as above, but dispatch over the given domain instead of the output image extent, and
+    // bind the indexed descriptor set. This is used by the kernels where each invocation produces
+    // more than one output pixel, and by the pipelines recorded multiple times in one command
+    // buffer.
+    void recordComputeCommands(VkCommandBuffer cmd, const void* pushConstantData,
+                               const Image& inputImage, const Image& outputImage,
+                               const Buffer* uniformBuffer, uint32_t descriptorSetIndex,
+                               VkExtent2D dispatchExtent);
+
    protected:
     // Initialization
-    bool createDescriptorSet(bool useUniformBuffer);
+    bool createInputSampler(VkFilter filter);
+    bool createDescriptorSets(bool useUniformBuffer, uint32_t numDescriptorSets);
     bool createComputePipeline(const char* shader, AAssetManager* assetManager);
 
-    // Update descriptor sets with the given input and output image.
-    bool updateDescriptorSets(const Image& inputImage, const Image& outputImage,
-                              const Buffer* uniformBuffer);
+    // Create the descriptor set layout with the given bindings, and allocate numDescriptorSets
+    // descriptor sets of the layout per frame from a descriptor pool owned by the pipeline. This is
+    // used by the pipelines with a different set of resources than the input and output images.
+    bool createDescriptorSets(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                              uint32_t numDescriptorSets);
+
+    // Return the indexed descriptor set of the current frame.
+    VkDescriptorSet getDescriptorSet(uint32_t index) const {
+        return mDescriptorSets[mFrame * mNumDescriptorSetsPerFrame + index];
+    }
+
+    // Update the indexed descriptor set with the given input and output image.
+    bool updateDescriptorSet(VkDescriptorSet descriptorSet, const Image& inputImage,
+                             const Image& outputImage, const Buffer* uniformBuffer);
+
+    // Record the pipeline with the indexed descriptor set, which must have been updated, and
+    // dispatch over the given domain.
+    void recordDispatch(VkCommandBuffer cmd, const void* pushConstantData,
+                        uint32_t descriptorSetIndex, VkExtent2D dispatchExtent);
 
     // Context
     const VulkanContext* mContext;
 
     // Compute pipeline
+    VulkanSampler mInputSampler;
     VulkanDescriptorSetLayout mDescriptorSetLayout;
+    VulkanDescriptorPool mDescriptorPool;
     VulkanPipelineLayout mPipelineLayout;
-    VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> mDescriptorSets;
+    uint32_t mNumDescriptorSetsPerFrame = 0;
+    uint32_t mFrame = 0;
     VulkanPipeline mPipeline;
     uint32_t mPushConstantSize;
 };
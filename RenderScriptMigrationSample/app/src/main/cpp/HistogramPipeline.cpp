@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HistogramPipeline.h"
+
+#include <android/asset_manager_jni.h>
+
+#include <vector>
+
+#include "Utils.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+std::unique_ptr<HistogramPipeline> HistogramPipeline::create(const VulkanContext* context,
+                                                             AAssetManager* assetManager) {
+    const bool useSubgroup = context->supportsSubgroupOperations(VK_SUBGROUP_FEATURE_BASIC_BIT |
+                                                                 VK_SUBGROUP_FEATURE_BALLOT_BIT);
+    const char* shader = useSubgroup ? "shaders/vulkan11/HistogramSubgroup.comp.spv"
+                                     : "shaders/Histogram.comp.spv";
+    LOGV("Histogram shader: %s", shader);
+
+    auto pipeline = std::make_unique<HistogramPipeline>(context);
+    const bool success = pipeline->createDescriptorSets() &&
+                         pipeline->createComputePipeline(shader, assetManager);
+    return success ? std::move(pipeline) : nullptr;
+}
+
+bool HistogramPipeline::createDescriptorSets() {
+    const std::vector<VkDescriptorSetLayoutBinding> descriptorsetLayoutBinding = {
+            {
+                    .binding = 0,  // input image
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                    .binding = 1,  // histogram
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+    };
+    return ComputePipeline::createDescriptorSets(descriptorsetLayoutBinding,
+                                                 /*numDescriptorSets=*/1);
+}
+
+void HistogramPipeline::recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                                              const Buffer& histogramBuffer) {
+    // Update descriptor sets with the input image and the histogram buffer
+    const auto inputImageInfo = inputImage.getDescriptor();
+    const auto histogramInfo = histogramBuffer.getDescriptor();
+    const std::vector<VkWriteDescriptorSet> writeDescriptorSet = {
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo = &inputImageInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pImageInfo = nullptr,
+                    .pBufferInfo = &histogramInfo,
+                    .pTexelBufferView = nullptr,
+            },
+    };
+    vkUpdateDescriptorSets(mContext->device(), static_cast<uint32_t>(writeDescriptorSet.size()),
+                           writeDescriptorSet.data(), 0, nullptr);
+
+    // Clear the histograms, and make the cleared buffer visible to the compute shader.
+    vkCmdFillBuffer(cmd, histogramBuffer.getBufferHandle(), 0, VK_WHOLE_SIZE, 0);
+    const VkBufferMemoryBarrier clearBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = histogramBuffer.getBufferHandle(),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 1, &clearBarrier, 0, nullptr);
+
+    // Each invocation reads one pixel of the input image.
+    recordDispatch(cmd, nullptr, 0, {inputImage.width(), inputImage.height()});
+
+    // Make the histograms visible to the host.
+    const VkBufferMemoryBarrier hostBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = histogramBuffer.getBufferHandle(),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &hostBarrier, 0, nullptr);
+}
+
+}  // namespace sample
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_HISTOGRAM_PIPELINE_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_HISTOGRAM_PIPELINE_H
+
+#include <android/asset_manager_jni.h>
+#include <vulkan/vulkan_core.h>
+
+#include <memory>
+
+#include "ComputePipeline.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+// The number of bins of the histogram of each channel.
+constexpr uint32_t kNumHistogramBins = 256;
+
+// The number of elements of the RGBA histograms. The count of value v in channel c is at index
+// v * 4 + c, which is the layout of the output of ScriptIntrinsicHistogram.
+constexpr uint32_t kHistogramSize = kNumHistogramBins * 4;
+
+// HistogramPipeline computes the per-channel histograms of a 2D image into a storage buffer. Each
+// work group reduces its histograms in shared memory before adding them to the storage buffer
+// with global atomics. If the device supports subgroup ballot operations, the invocations of a
+// subgroup with the same value are further aggregated into a single shared memory atomic.
+class HistogramPipeline : public ComputePipeline {
+   public:
+    // Create a histogram pipeline, choosing the subgroup variant of the shader if supported.
+    // Return the created HistogramPipeline on success, or nullptr if failed.
+    static std::unique_ptr<HistogramPipeline> create(const VulkanContext* context,
+                                                     AAssetManager* assetManager);
+
+    // Prefer HistogramPipeline::create
+    explicit HistogramPipeline(const VulkanContext* context)
+        : ComputePipeline(context, /*pushConstantSize=*/0) {}
+
+    // Record the commands to clear the histogram buffer and accumulate the histograms of the
+    // input image. The histogram buffer must hold kHistogramSize uint32_t elements, and be created
+    // with VK_BUFFER_USAGE_STORAGE_BUFFER_BIT and VK_BUFFER_USAGE_TRANSFER_DST_BIT. The results
+    // are made visible to the host once the command buffer is finished.
+    void recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                               const Buffer& histogramBuffer);
+
+   private:
+    // Initialization
+    bool createDescriptorSets();
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_HISTOGRAM_PIPELINE_H
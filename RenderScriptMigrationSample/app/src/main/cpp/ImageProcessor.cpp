@@ -19,15 +19,74 @@
 #include <android/asset_manager_jni.h>
 #include <android/bitmap.h>
 
+#include <algorithm>
+#include <cinttypes>
 #include <cmath>
+#include <initializer_list>
 
 #include "ComputePipeline.h"
 #include "Utils.h"
 #include "VulkanResources.h"
+#include "cpu/BoxBlur.h"
+#include "cpu/ColorMatrix.h"
+#include "cpu/GaussianBlur.h"
 
 namespace sample {
 namespace {
 
+// The maximum radius of the box blur filters.
+constexpr float kMaxBoxBlurRadius = 500.0f;
+
+// The minimum number of output pixels computed by each invocation of the box blur kernels. Each
+// invocation sums up 2 * radius + 1 pixels before sliding the window, so the segment is never
+// shorter than the window to keep the cost per pixel independent of the radius.
+constexpr int32_t kMinBoxBlurSegmentLength = 32;
+
+// The maximum radius of the pyramid blur.
+constexpr float kMaxPyramidBlurRadius = 500.0f;
+
+// The maximum number of pyramid levels below the full resolution.
+constexpr uint32_t kMaxPyramidLevels = 6;
+
+// The approximate variance per axis, in pixels^2, added by a pair of dual filter downsample and
+// upsample, measured at the resolution of the higher level. This includes the variance of the
+// bilinear reconstruction in the upsample.
+constexpr float kDualFilterVariance = 2.75f;
+
+// The minimum standard deviation, in pixels of the lowest level, of the gaussian applied at the
+// lowest pyramid level when the pyramid blur runs at the highest quality.
+constexpr float kMaxQualityResidualSigma = 3.0f;
+
+struct PyramidBlurPlan {
+    // The number of pyramid levels to go down.
+    uint32_t levels;
+    // The radius of the gaussian blur at the lowest level, 0 if no gaussian blur is needed.
+    float residualRadius;
+};
+
+// Choose the number of pyramid levels for a gaussian blur of the given radius. The variance added
+// by the dual filters of each level grows by 4x per level, and the remaining variance is applied
+// by a gaussian kernel at the lowest level. Go down as many levels as possible, as long as the
+// dual filters do not over-blur, and the gaussian at the lowest level is wide enough for the
+// quality.
+PyramidBlurPlan planPyramidBlur(float radius, float quality) {
+    const float sigma = 0.4f * radius + 0.6f;
+    const float variance = sigma * sigma;
+    const float minResidualSigma = quality * kMaxQualityResidualSigma;
+    for (uint32_t levels = kMaxPyramidLevels; levels > 0; levels--) {
+        const auto scale = static_cast<float>(1u << levels);
+        const float pyramidVariance = kDualFilterVariance * (scale * scale - 1.0f) / 3.0f;
+        if (pyramidVariance > variance) continue;
+        const float residualSigma = std::sqrt(variance - pyramidVariance) / scale;
+        if (residualSigma < minResidualSigma) continue;
+
+        // Invert sigma = 0.4 * radius + 0.6, and skip the gaussian if it is narrower than radius 1.
+        const float residualRadius = (residualSigma - 0.6f) / 0.4f;
+        return {levels, residualRadius < 1.0f ? 0.0f : std::min(residualRadius, 25.0f)};
+    }
+    return {0, std::min(radius, 25.0f)};
+}
+
 bool beginOneTimeCommandBuffer(VkCommandBuffer cmd) {
     const VkCommandBufferBeginInfo commandBufferBeginInfo = {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -39,38 +98,48 @@ bool beginOneTimeCommandBuffer(VkCommandBuffer cmd) {
     return true;
 }
 
-bool endAndSubmitCommandBuffer(VkCommandBuffer cmd, VkQueue queue) {
+bool endAndSubmitCommandBuffer(VkCommandBuffer cmd, const VulkanContext& context,
+                               uint64_t waitValue, uint64_t* submission,
+                               const VulkanContext::SubmitSemaphores& semaphores = {}) {
     // End command buffer recording
     CALL_VK(vkEndCommandBuffer, cmd);
 
-    // Submit queue
-    const VkSubmitInfo submitDesc = {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .waitSemaphoreCount = 0,
-            .pWaitSemaphores = nullptr,
-            .pWaitDstStageMask = nullptr,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &cmd,
-            .signalSemaphoreCount = 0,
-            .pSignalSemaphores = nullptr,
-    };
-    CALL_VK(vkQueueSubmit, queue, 1, &submitDesc, VK_NULL_HANDLE);
-    CALL_VK(vkQueueWaitIdle, queue);
+    // Submit queue after the timeline reaches waitValue, without waiting for the command buffer
+    // to finish
+    RET_CHECK(context.submit(cmd, waitValue, submission, semaphores));
     return true;
 }
 
-void recordImageCopyingCommand(VkCommandBuffer cmd, const Image& src, const Image& dst) {
+// Record the copy of the region of the source image to the same region of the destination image.
+void recordImageCopyingCommand(VkCommandBuffer cmd, const Image& src, const Image& dst,
+                               const VkRect2D& region) {
+    const VkOffset3D offset = {region.offset.x, region.offset.y, 0};
     const VkImageCopy imageCopy = {
             .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-            .srcOffset = {0, 0, 0},
+            .srcOffset = offset,
             .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-            .dstOffset = {0, 0, 0},
-            .extent = {src.width(), src.height(), 1},
+            .dstOffset = offset,
+            .extent = {region.extent.width, region.extent.height, 1},
     };
     vkCmdCopyImage(cmd, src.getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                    dst.getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
 }
 
+// Expand the rect by marginX and marginY pixels on each side, and clip it to width x height.
+// Return an empty rect if nothing is left.
+VkRect2D expandAndClipRect(const VkRect2D& rect, int32_t marginX, int32_t marginY, uint32_t width,
+                           uint32_t height) {
+    const int64_t left = std::max<int64_t>(int64_t{rect.offset.x} - marginX, 0);
+    const int64_t top = std::max<int64_t>(int64_t{rect.offset.y} - marginY, 0);
+    const int64_t right =
+            std::min<int64_t>(int64_t{rect.offset.x} + rect.extent.width + marginX, width);
+    const int64_t bottom =
+            std::min<int64_t>(int64_t{rect.offset.y} + rect.extent.height + marginY, height);
+    if (left >= right || top >= bottom) return {};
+    return {{static_cast<int32_t>(left), static_cast<int32_t>(top)},
+            {static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top)}};
+}
+
 }  // namespace
 
 std::unique_ptr<ImageProcessor> ImageProcessor::create(bool enableDebug,
@@ -80,23 +149,36 @@ std::unique_ptr<ImageProcessor> ImageProcessor::create(bool enableDebug,
     return success ? std::move(processor) : nullptr;
 }
 
+ImageProcessor::~ImageProcessor() {
+    if (mContext != nullptr) waitForCompletion();
+}
+
 bool ImageProcessor::initialize(bool enableDebug, AAssetManager* assetManager) {
-    // Create context
-    mContext = VulkanContext::create(enableDebug);
+    // Get the context shared with the other processors
+    mContext = VulkanContext::getShared(enableDebug);
     RET_CHECK(mContext != nullptr);
 
-    // Allocate command buffer
-    mCommandBuffer =
-            std::make_unique<VulkanCommandBuffer>(mContext->device(), mContext->commandPool());
+    // Create command pool and allocate command buffers for the frames and the readbacks
+    RET_CHECK(mContext->createCommandPool(&mCommandPool));
     const VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
             .pNext = nullptr,
-            .commandPool = mContext->commandPool(),
+            .commandPool = mCommandPool.handle(),
             .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
             .commandBufferCount = 1,
     };
-    CALL_VK(vkAllocateCommandBuffers, mContext->device(), &commandBufferAllocateInfo,
-            mCommandBuffer->pHandle());
+    for (auto& frame : mFrames) {
+        frame.commandBuffer =
+                std::make_unique<VulkanCommandBuffer>(mContext->device(), mCommandPool.handle());
+        CALL_VK(vkAllocateCommandBuffers, mContext->device(), &commandBufferAllocateInfo,
+                frame.commandBuffer->pHandle());
+    }
+    for (auto& readback : mReadbackBuffers) {
+        readback.commandBuffer =
+                std::make_unique<VulkanCommandBuffer>(mContext->device(), mCommandPool.handle());
+        CALL_VK(vkAllocateCommandBuffers, mContext->device(), &commandBufferAllocateInfo,
+                readback.commandBuffer->pHandle());
+    }
 
     // Create compute pipeline for hue rotation
     mRotateHuePipeline =
@@ -104,43 +186,211 @@ bool ImageProcessor::initialize(bool enableDebug, AAssetManager* assetManager) {
                                     sizeof(mRotateHueData), /*useUniformBuffer=*/false);
     RET_CHECK(mRotateHuePipeline != nullptr);
 
-    // Create two compute pipelines for blur
-    mBlurUniformBuffer = Buffer::create(
-            mContext.get(), sizeof(mBlurData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    RET_CHECK(mBlurUniformBuffer != nullptr);
+    // Create compute pipeline for saturation
+    mSaturationPipeline =
+            ComputePipeline::create(mContext.get(), "shaders/Saturation.comp.spv", assetManager,
+                                    sizeof(mSaturationData), /*useUniformBuffer=*/false);
+    RET_CHECK(mSaturationPipeline != nullptr);
+
+    // Create two compute pipelines for blur, with a uniform buffer per frame
+    for (auto& frame : mFrames) {
+        frame.blurUniformBuffer = Buffer::create(
+                mContext.get(), sizeof(mBlurData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        RET_CHECK(frame.blurUniformBuffer != nullptr);
+    }
     mBlurHorizontalPipeline =
             ComputePipeline::create(mContext.get(), "shaders/BlurHorizontal.comp.spv", assetManager,
-                                    sizeof(int32_t), /*useUniformBuffer=*/true);
+                                    sizeof(mBlurPassData), /*useUniformBuffer=*/true);
     RET_CHECK(mBlurHorizontalPipeline != nullptr);
     mBlurVerticalPipeline =
             ComputePipeline::create(mContext.get(), "shaders/BlurVertical.comp.spv", assetManager,
-                                    sizeof(int32_t), /*useUniformBuffer=*/true);
+                                    sizeof(mBlurPassData), /*useUniformBuffer=*/true);
     RET_CHECK(mBlurVerticalPipeline != nullptr);
+
+    // Create two compute pipelines for box blur. Each pass of the stacked box blur needs its own
+    // descriptor sets.
+    mBoxBlurHorizontalPipeline = ComputePipeline::create(
+            mContext.get(), "shaders/BoxBlurHorizontal.comp.spv", assetManager,
+            sizeof(mBoxBlurData), /*useUniformBuffer=*/false, cpu::kNumStackedBoxes);
+    RET_CHECK(mBoxBlurHorizontalPipeline != nullptr);
+    mBoxBlurVerticalPipeline = ComputePipeline::create(
+            mContext.get(), "shaders/BoxBlurVertical.comp.spv", assetManager, sizeof(mBoxBlurData),
+            /*useUniformBuffer=*/false, cpu::kNumStackedBoxes);
+    RET_CHECK(mBoxBlurVerticalPipeline != nullptr);
+
+    // Create two compute pipelines for pyramid blur. Both sample the input image bilinearly, and
+    // are recorded once per pyramid level.
+    mPyramidDownsamplePipeline = ComputePipeline::create(
+            mContext.get(), "shaders/DualFilterDownsample.comp.spv", assetManager,
+            /*pushConstantSize=*/0, /*useUniformBuffer=*/false, kMaxPyramidLevels,
+            VK_FILTER_LINEAR);
+    RET_CHECK(mPyramidDownsamplePipeline != nullptr);
+    mPyramidUpsamplePipeline = ComputePipeline::create(
+            mContext.get(), "shaders/DualFilterUpsample.comp.spv", assetManager,
+            /*pushConstantSize=*/0, /*useUniformBuffer=*/false, kMaxPyramidLevels,
+            VK_FILTER_LINEAR);
+    RET_CHECK(mPyramidUpsamplePipeline != nullptr);
+
+    // Create compute pipeline for histogram. The histogram buffer is read back by the host.
+    mHistogramBuffer = Buffer::create(
+            mContext.get(), kHistogramSize * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    RET_CHECK(mHistogramBuffer != nullptr);
+    mHistogramPipeline = HistogramPipeline::create(mContext.get(), assetManager);
+    RET_CHECK(mHistogramPipeline != nullptr);
+
+    // Create compute pipelines for LUT and 3D LUT, with a uniform buffer per frame for LUT
+    for (auto& frame : mFrames) {
+        frame.lutUniformBuffer = Buffer::create(
+                mContext.get(), sizeof(mLutData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        RET_CHECK(frame.lutUniformBuffer != nullptr);
+    }
+    mLutPipeline = ComputePipeline::create(mContext.get(), "shaders/Lut.comp.spv", assetManager,
+                                           /*pushConstantSize=*/0, /*useUniformBuffer=*/true);
+    RET_CHECK(mLutPipeline != nullptr);
+    mLut3DPipeline = Lut3DPipeline::create(mContext.get(), assetManager);
+    RET_CHECK(mLut3DPipeline != nullptr);
+
+    // Create two compute pipelines for resize
+    mResizeHorizontalPipeline = ResizePipeline::create(
+            mContext.get(), "shaders/ResizeHorizontal.comp.spv", assetManager);
+    RET_CHECK(mResizeHorizontalPipeline != nullptr);
+    mResizeVerticalPipeline =
+            ResizePipeline::create(mContext.get(), "shaders/ResizeVertical.comp.spv", assetManager);
+    RET_CHECK(mResizeVerticalPipeline != nullptr);
+    return true;
+}
+
+bool ImageProcessor::waitForCompletion() {
+    return mContext->waitForTimeline(mLastSubmission);
+}
+
+bool ImageProcessor::beginFrame() {
+    mFrameIndex = (mFrameIndex + 1) % kMaxFramesInFlight;
+    RET_CHECK(mContext->waitForTimeline(mFrames[mFrameIndex].submission));
+    for (ComputePipeline* pipeline : std::initializer_list<ComputePipeline*>{
+                 mRotateHuePipeline.get(), mSaturationPipeline.get(),
+                 mBlurHorizontalPipeline.get(), mBlurVerticalPipeline.get(),
+                 mBoxBlurHorizontalPipeline.get(), mBoxBlurVerticalPipeline.get(),
+                 mPyramidDownsamplePipeline.get(), mPyramidUpsamplePipeline.get(),
+                 mHistogramPipeline.get(), mLutPipeline.get(), mLut3DPipeline.get(),
+                 mResizeHorizontalPipeline.get(), mResizeVerticalPipeline.get()}) {
+        pipeline->setFrame(mFrameIndex);
+    }
+    return true;
+}
+
+bool ImageProcessor::endAndSubmitFrame(VkCommandBuffer cmd,
+                                       const VulkanContext::SubmitSemaphores& semaphores) {
+    // The submission starts after the previous one of this processor, which may write the images
+    // it reads, so the host does not need to wait in between.
+    RET_CHECK(endAndSubmitCommandBuffer(cmd, *mContext, mLastSubmission, &mLastSubmission,
+                                        semaphores));
+    mFrames[mFrameIndex].submission = mLastSubmission;
     return true;
 }
 
 bool ImageProcessor::configureInputAndOutput(JNIEnv* env, jobject inputBitmap,
                                              int numberOfOutputImages) {
+    RET_CHECK(waitForCompletion());
+
+    // Release the images of the previous configuration before allocating the new ones.
+    releaseImages();
+
     // Create input image from bitmap
     mInputImage = Image::createFromBitmap(mContext.get(), env, inputBitmap);
     RET_CHECK(mInputImage != nullptr);
     LOGV("Input image width = %d, height = %d", mInputImage->width(), mInputImage->height());
+    return allocateImages(numberOfOutputImages);
+}
 
-    // Create intermediate image for blur
-    mTempImage =
-            Image::createDeviceLocal(mContext.get(), mInputImage->width(), mInputImage->height(),
-                                     VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
-    RET_CHECK(mTempImage != nullptr);
+bool ImageProcessor::configureInputAndOutput(JNIEnv* env, jobject inputBitmap,
+                                             int numberOfOutputImages, uint32_t width,
+                                             uint32_t height, cpu::ResizeFilter filter) {
+    RET_CHECK(width > 0 && height > 0);
+    RET_CHECK(waitForCompletion());
 
-    // Create staging output image
-    mStagingOutputImage =
-            Image::createDeviceLocal(mContext.get(), mInputImage->width(), mInputImage->height(),
-                                     VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
-    RET_CHECK(mStagingOutputImage != nullptr);
+    // Release the images of the previous configuration before allocating the new ones.
+    releaseImages();
 
-    // Create output images backed by AHardwareBuffer
+    // Create the full resolution image from bitmap, and resize it if needed
+    auto sourceImage = Image::createFromBitmap(mContext.get(), env, inputBitmap);
+    RET_CHECK(sourceImage != nullptr);
+    if (sourceImage->width() == width && sourceImage->height() == height) {
+        mInputImage = std::move(sourceImage);
+    } else {
+        RET_CHECK(resizeInput(*sourceImage, width, height, filter));
+    }
+    LOGV("Input image width = %d, height = %d", mInputImage->width(), mInputImage->height());
+    return allocateImages(numberOfOutputImages);
+}
+
+bool ImageProcessor::resizeInput(const Image& sourceImage, uint32_t width, uint32_t height,
+                                 cpu::ResizeFilter filter) {
+    // Precompute the taps of each output column and row
+    const auto horizontalTaps = cpu::computeResizeTaps(filter, sourceImage.width(), width);
+    const auto verticalTaps = cpu::computeResizeTaps(filter, sourceImage.height(), height);
+    const auto horizontalTapBuffer =
+            ResizePipeline::createTapBuffer(mContext.get(), horizontalTaps);
+    RET_CHECK(horizontalTapBuffer != nullptr);
+    const auto verticalTapBuffer = ResizePipeline::createTapBuffer(mContext.get(), verticalTaps);
+    RET_CHECK(verticalTapBuffer != nullptr);
+
+    // The horizontal pass writes to a half float image with the resized width and the source
+    // height, and the vertical pass writes to the new input image.
+    auto intermediateImage = Image::createDeviceLocal(
+            mContext.get(), width, sourceImage.height(),
+            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_FORMAT_R16G16B16A16_SFLOAT);
+    RET_CHECK(intermediateImage != nullptr);
+    mInputImage = Image::createDeviceLocal(mContext.get(), width, height,
+                                           VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    RET_CHECK(mInputImage != nullptr);
+
+    RET_CHECK(beginFrame());
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+    intermediateImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
+                                                     /*preserveData=*/false);
+    mResizeHorizontalPipeline->recordComputeCommands(cmd, sourceImage, *intermediateImage,
+                                                     *horizontalTapBuffer, horizontalTaps.numTaps);
+    intermediateImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    mInputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
+                                               /*preserveData=*/false);
+    mResizeVerticalPipeline->recordComputeCommands(cmd, *intermediateImage, *mInputImage,
+                                                   *verticalTapBuffer, verticalTaps.numTaps);
+
+    // The input image is only sampled by the filters from now on.
+    mInputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    RET_CHECK(endAndSubmitFrame(cmd));
+
+    // The tap buffers and the intermediate image are released on return.
+    RET_CHECK(waitForCompletion());
+    return true;
+}
+
+bool ImageProcessor::allocateImages(int numberOfOutputImages) {
     RET_CHECK(numberOfOutputImages > 0);
+
+    // Fail early rather than exhausting the device memory with the output and transient images.
+    // The aliased transient images take about two frames.
+    const uint64_t imageSize = uint64_t{mInputImage->width()} * mInputImage->height() * 4;
+    const uint64_t requiredSize = imageSize * static_cast<uint64_t>(numberOfOutputImages + 2);
+    const auto budget = mContext->getDeviceLocalMemoryBudget();
+    if (budget.usage + requiredSize > budget.budget) {
+        LOGE("Not enough device memory: %" PRIu64 " bytes required, %" PRIu64 " of %" PRIu64
+             " bytes in use",
+             requiredSize, budget.usage, budget.budget);
+        return false;
+    }
+
+    // Create the staging output image and the intermediate images
+    declareTransientImages();
+    RET_CHECK(acquireTransientImages());
+
+    // Create output images backed by AHardwareBuffer
     mOutputImages.resize(numberOfOutputImages);
     for (int i = 0; i < numberOfOutputImages; i++) {
         const AHardwareBuffer_Desc ahwbDesc = {
@@ -161,82 +411,478 @@ bool ImageProcessor::configureInputAndOutput(JNIEnv* env, jobject inputBitmap,
     return true;
 }
 
+void ImageProcessor::releaseImages() {
+    // The cached results are computed from the released input image.
+    mInputGeneration++;
+    if (mResultCache != nullptr) mResultCache->clear();
+    mInputImage = nullptr;
+    mOutputImages.clear();
+    mTransientAllocator = nullptr;
+    mStagingOutputImage = nullptr;
+    mTempImage = nullptr;
+    mTempImage2 = nullptr;
+    mPyramidImages.clear();
+    mPyramidTempImages.clear();
+    for (auto& readback : mReadbackBuffers) readback.buffer = nullptr;
+}
+
+void ImageProcessor::declareTransientImages() {
+    const uint32_t width = mInputImage->width();
+    const uint32_t height = mInputImage->height();
+    constexpr VkImageUsageFlags kIntermediateUsage =
+            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    mTransientAllocator = std::make_unique<TransientAllocator>(mContext.get());
+    auto& allocator = *mTransientAllocator;
+    auto& indices = mTransientIndices;
+    indices.stagingOutput = allocator.declareImage(
+            width, height, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    indices.temp = allocator.declareImage(width, height, kIntermediateUsage);
+    indices.temp2 = allocator.declareImage(width, height, kIntermediateUsage);
+    indices.pyramid.clear();
+    indices.pyramidTemp.clear();
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+    for (uint32_t i = 0; i < kMaxPyramidLevels; i++) {
+        levelWidth = std::max(1u, (levelWidth + 1) / 2);
+        levelHeight = std::max(1u, (levelHeight + 1) / 2);
+        indices.pyramid.push_back(allocator.declareImage(levelWidth, levelHeight,
+                                                         kIntermediateUsage));
+        indices.pyramidTemp.push_back(allocator.declareImage(levelWidth, levelHeight,
+                                                             kIntermediateUsage));
+    }
+
+    // The single pass filters: the shader writes to the staging image, which is then copied.
+    allocator.beginChain();
+    allocator.declareUse(indices.stagingOutput, 0, 1);
+
+    // The two-pass blurs, including the pyramid blur without pyramid levels: the first pass
+    // writes to the temp image, the second pass reads it and writes to the staging image.
+    allocator.beginChain();
+    allocator.declareUse(indices.temp, 0, 1);
+    allocator.declareUse(indices.stagingOutput, 1, 2);
+
+    // The stacked box blur: the passes ping-pong between the two temp images, and the last pass
+    // reads the first temp image and writes to the staging image. The staging image may alias
+    // the second temp image.
+    constexpr uint32_t kNumPasses = 2 * cpu::kNumStackedBoxes;
+    allocator.beginChain();
+    allocator.declareUse(indices.temp, 0, kNumPasses - 1);
+    allocator.declareUse(indices.temp2, 1, kNumPasses - 2);
+    allocator.declareUse(indices.stagingOutput, kNumPasses - 1, kNumPasses);
+
+    // The pyramid blur: all passes up to the last upsample are counted as the first step. The
+    // last upsample reads the level 1 image and writes to the staging image, which may alias the
+    // temp images of the gaussian blur.
+    allocator.beginChain();
+    for (uint32_t i = 0; i < kMaxPyramidLevels; i++) {
+        allocator.declareUse(indices.pyramid[i], 0, 1);
+        allocator.declareUse(indices.pyramidTemp[i], 0, 0);
+    }
+    allocator.declareUse(indices.stagingOutput, 1, 2);
+}
+
+bool ImageProcessor::acquireTransientImages() {
+    RET_CHECK(mTransientAllocator->allocate());
+    mTransientAllocator->discardContent();
+
+    const auto& allocator = *mTransientAllocator;
+    const auto& indices = mTransientIndices;
+    mStagingOutputImage = allocator.getImage(indices.stagingOutput);
+    mTempImage = allocator.getImage(indices.temp);
+    mTempImage2 = allocator.getImage(indices.temp2);
+    mPyramidImages.resize(kMaxPyramidLevels);
+    mPyramidTempImages.resize(kMaxPyramidLevels);
+    for (uint32_t i = 0; i < kMaxPyramidLevels; i++) {
+        mPyramidImages[i] = allocator.getImage(indices.pyramid[i]);
+        mPyramidTempImages[i] = allocator.getImage(indices.pyramidTemp[i]);
+    }
+    return true;
+}
+
+bool ImageProcessor::setMemoryBudget(uint64_t budget) {
+    mMemoryBudget = budget;
+    return enforceMemoryBudget();
+}
+
+uint64_t ImageProcessor::getMemoryUsage() const {
+    uint64_t usage = 0;
+    const auto addImage = [&usage](const std::unique_ptr<Image>& image) {
+        if (image != nullptr) usage += image->memorySize();
+    };
+    addImage(mInputImage);
+    std::for_each(mOutputImages.begin(), mOutputImages.end(), addImage);
+    if (mTransientAllocator != nullptr) usage += mTransientAllocator->memorySize();
+    if (mLut3D != nullptr) usage += mLut3D->memorySize();
+    if (mResultCache != nullptr) usage += mResultCache->memorySize();
+    return usage;
+}
+
+bool ImageProcessor::enforceMemoryBudget() {
+    const auto withinBudget = [this] {
+        return mMemoryBudget == 0 || getMemoryUsage() <= mMemoryBudget;
+    };
+    if (withinBudget()) return true;
+
+    // The cached resources may still be used by the pending commands.
+    RET_CHECK(waitForCompletion());
+
+    // Release the cached results first, as they are only an optimization, then the 3D lookup
+    // table, as it is only used by one filter. The transient images share one allocation, and
+    // are released together.
+    if (!withinBudget() && mResultCache != nullptr) mResultCache->clear();
+    if (!withinBudget()) mLut3D = nullptr;
+    if (!withinBudget() && mTransientAllocator != nullptr) {
+        mTransientAllocator->release();
+        mStagingOutputImage = nullptr;
+        mTempImage = nullptr;
+        mTempImage2 = nullptr;
+        std::fill(mPyramidImages.begin(), mPyramidImages.end(), nullptr);
+        std::fill(mPyramidTempImages.begin(), mPyramidTempImages.end(), nullptr);
+    }
+    if (!withinBudget()) {
+        LOGV("The input and output images alone exceed the memory budget of %" PRIu64 " bytes",
+             mMemoryBudget);
+    }
+    return true;
+}
+
+bool ImageProcessor::setOutputWindow(ANativeWindow* window) {
+    // The swapchain waits for its queued presentations when destroyed.
+    RET_CHECK(waitForCompletion());
+    mSwapchain = nullptr;
+    if (window == nullptr) return true;
+    mSwapchain = Swapchain::create(mContext.get(), window);
+    RET_CHECK(mSwapchain != nullptr);
+    return true;
+}
+
+bool ImageProcessor::recordOutputAndSubmit(VkCommandBuffer cmd, int outputIndex) {
+    return recordOutputAndSubmit(cmd, outputIndex, getImageRect());
+}
+
+bool ImageProcessor::recordOutputAndSubmit(VkCommandBuffer cmd, int outputIndex,
+                                           const VkRect2D& region) {
+    // Keep a copy of the result in the cache. The cache image is left in the layout of the copy to
+    // the output on a cache hit.
+    if (mResultCacheTarget != nullptr) {
+        Image* cacheImage = mResultCacheTarget;
+        mStagingOutputImage->recordLayoutTransitionBarrier(cmd,
+                                                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        cacheImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                  /*preserveData=*/false);
+        recordImageCopyingCommand(cmd, *mStagingOutputImage, *cacheImage, region);
+        cacheImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    }
+    RET_CHECK(recordCopyAndSubmit(cmd, mStagingOutputImage, outputIndex, region));
+
+    // The filter may have acquired transient images or cached resources beyond the budget.
+    RET_CHECK(enforceMemoryBudget());
+    return true;
+}
+
+bool ImageProcessor::recordCopyAndSubmit(VkCommandBuffer cmd, Image* sourceImage, int outputIndex,
+                                         const VkRect2D& region) {
+    // Prepare for image copying from the source image to the output image.
+    sourceImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    if (outputIndex != kWindowOutput) {
+        if (outputIndex < 0 || outputIndex >= numOutputImages()) {
+            LOGE("Invalid output index %d", outputIndex);
+            vkEndCommandBuffer(cmd);
+            return false;
+        }
+
+        // Copy source image to output image.
+        recordImageCopyingCommand(cmd, *sourceImage, *mOutputImages[outputIndex], region);
+
+        // Submit to queue.
+        RET_CHECK(endAndSubmitFrame(cmd));
+        return true;
+    }
+
+    // Blit the source image to the acquired swapchain image. The command buffer is ended on
+    // failure too, so that it can be recorded again.
+    uint32_t imageIndex = 0;
+    if (mSwapchain == nullptr || !mSwapchain->acquireNextImage(&imageIndex)) {
+        LOGE("Failed to acquire an image of the output window");
+        vkEndCommandBuffer(cmd);
+        return false;
+    }
+    mSwapchain->recordBlit(cmd, *sourceImage, imageIndex);
+
+    // Submit to queue, and queue the presentation after the submission.
+    RET_CHECK(endAndSubmitFrame(cmd, mSwapchain->getSubmitSemaphores(imageIndex)));
+    RET_CHECK(mSwapchain->present(imageIndex));
+    return true;
+}
+
+std::future<const uint8_t*> ImageProcessor::readback(int outputIndex) {
+    const uint8_t* data = nullptr;
+    uint64_t submission = 0;
+    if (!submitReadback(outputIndex, &data, &submission)) {
+        std::promise<const uint8_t*> failure;
+        failure.set_value(nullptr);
+        return failure.get_future();
+    }
+
+    // The future waits for the copy when the caller asks for the pixels. It only holds the shared
+    // context, so it may be waited for on any thread.
+    return std::async(std::launch::deferred, [context = mContext, data, submission] {
+        return context->waitForTimeline(submission) ? data : nullptr;
+    });
+}
+
+bool ImageProcessor::submitReadback(int outputIndex, const uint8_t** data, uint64_t* submission) {
+    RET_CHECK(0 <= outputIndex && outputIndex < static_cast<int>(mOutputImages.size()));
+    Image* outputImage = mOutputImages[outputIndex].get();
+    auto& readback = mReadbackBuffers[mNextReadbackBuffer];
+    mNextReadbackBuffer = (mNextReadbackBuffer + 1) % kNumReadbackBuffers;
+
+    // The buffer and the command buffer may still be used by the readback before the previous.
+    RET_CHECK(mContext->waitForTimeline(readback.submission));
+    if (readback.buffer == nullptr) {
+        const uint64_t size = uint64_t{outputImage->width()} * outputImage->height() * 4;
+        RET_CHECK(size <= UINT32_MAX);
+        // Prefer cached memory, as the host reads every pixel.
+        constexpr VkMemoryPropertyFlags kHostProperties =
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        readback.buffer = Buffer::create(mContext.get(), static_cast<uint32_t>(size),
+                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         kHostProperties | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        if (readback.buffer == nullptr) {
+            readback.buffer = Buffer::create(mContext.get(), static_cast<uint32_t>(size),
+                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT, kHostProperties);
+        }
+        RET_CHECK(readback.buffer != nullptr);
+    }
+    *data = static_cast<const uint8_t*>(readback.buffer->map());
+    RET_CHECK(*data != nullptr);
+
+    // The copy starts after the filters writing to the output image, which are submitted earlier
+    // by this processor.
+    auto cmd = readback.commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+    outputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    const VkBufferImageCopy bufferImageCopy = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {outputImage->width(), outputImage->height(), 1},
+    };
+    vkCmdCopyImageToBuffer(cmd, outputImage->getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readback.buffer->getBufferHandle(), 1, &bufferImageCopy);
+
+    // Make the copy visible to the host, and return the output image to the layout expected by
+    // the filters.
+    const VkBufferMemoryBarrier hostBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = readback.buffer->getBufferHandle(),
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0,
+                         nullptr, 1, &hostBarrier, 0, nullptr);
+    outputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    RET_CHECK(endAndSubmitCommandBuffer(cmd, *mContext, mLastSubmission, &readback.submission));
+
+    // The next filter must not overwrite the output image before the copy has finished.
+    mLastSubmission = readback.submission;
+    *submission = readback.submission;
+    return true;
+}
+
+VkExtent2D ImageProcessor::imageExtent() const {
+    if (mInputImage == nullptr) return {0, 0};
+    return getImageRect().extent;
+}
+
+VkRect2D ImageProcessor::getImageRect() const {
+    return {{0, 0}, {mInputImage->width(), mInputImage->height()}};
+}
+
+VkRect2D ImageProcessor::getDamagedRegion(const VkRect2D& damage, int32_t footprint,
+                                          int outputIndex) const {
+    if (outputIndex == kWindowOutput) return getImageRect();
+    return expandAndClipRect(damage, footprint, footprint, mInputImage->width(),
+                             mInputImage->height());
+}
+
+bool ImageProcessor::updateInput(JNIEnv* env, jobject inputBitmap, const VkRect2D& rect) {
+    RET_CHECK(mInputImage != nullptr);
+    RET_CHECK(waitForCompletion());
+
+    // The cached results are computed from the previous input image, which is modified even if
+    // the update fails halfway.
+    mInputGeneration++;
+    if (mResultCache != nullptr) mResultCache->eraseStale(mInputGeneration);
+    RET_CHECK(mInputImage->updateFromBitmap(env, inputBitmap, rect));
+    return true;
+}
+
+bool ImageProcessor::setResultCache(uint64_t budget, float step) {
+    // The cached images may still be used by the pending commands.
+    RET_CHECK(waitForCompletion());
+    mResultCache = nullptr;
+    if (budget == 0) return true;
+    mResultCache = ResultCache::create(mContext.get(), budget, step);
+    RET_CHECK(mResultCache != nullptr);
+    return true;
+}
+
+template <typename Filter>
+bool ImageProcessor::runCachedFilter(CachedFilter filter, float parameter, int outputIndex,
+                                     Filter run) {
+    if (mResultCache == nullptr) return run(parameter);
+    const int64_t quantized = mResultCache->quantize(parameter);
+    const ResultCache::Key key = {mInputGeneration, static_cast<uint32_t>(filter), quantized};
+
+    // A hit copies the cached image after the pending commands, which may still write it.
+    Image* cachedImage = mResultCache->find(key);
+    if (cachedImage != nullptr) {
+        RET_CHECK(beginFrame());
+        auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+        RET_CHECK(beginOneTimeCommandBuffer(cmd));
+        RET_CHECK(recordCopyAndSubmit(cmd, cachedImage, outputIndex, getImageRect()));
+        return true;
+    }
+
+    // Run the filter with the quantized parameter, so that the result is the same for all the
+    // parameters of the key. The result is copied to the cache image by recordOutputAndSubmit.
+    // The filter may not fit in the budget, and then runs without caching. The images evicted to
+    // make room, or erased on failure, may still be used by the pending commands.
+    if (mResultCache->needsEviction(mInputImage->width(), mInputImage->height())) {
+        RET_CHECK(waitForCompletion());
+    }
+    mResultCacheTarget = mResultCache->insert(key, mInputImage->width(), mInputImage->height());
+    const bool success = run(mResultCache->dequantize(quantized));
+    mResultCacheTarget = nullptr;
+    if (!success) {
+        RET_CHECK(waitForCompletion());
+        mResultCache->erase(key);
+    }
+    return success;
+}
+
 bool ImageProcessor::rotateHue(float radian, int outputIndex) {
-    // Set HUE rotation matrix
-    // The matrix below performs a combined operation of,
-    // RGB->HSV transform * HUE rotation * HSV->RGB transform
-    const float cos = std::cos(radian);
-    const float sin = std::sin(radian);
-    mRotateHueData.colorMatrix[0][0] = 0.299f + 0.701f * cos + 0.168f * sin;
-    mRotateHueData.colorMatrix[0][1] = 0.299f - 0.299f * cos - 0.328f * sin;
-    mRotateHueData.colorMatrix[0][2] = 0.299f - 0.300f * cos + 1.250f * sin;
-    mRotateHueData.colorMatrix[1][0] = 0.587f - 0.587f * cos + 0.330f * sin;
-    mRotateHueData.colorMatrix[1][1] = 0.587f + 0.413f * cos + 0.035f * sin;
-    mRotateHueData.colorMatrix[1][2] = 0.587f - 0.588f * cos - 1.050f * sin;
-    mRotateHueData.colorMatrix[2][0] = 0.114f - 0.114f * cos - 0.497f * sin;
-    mRotateHueData.colorMatrix[2][1] = 0.114f - 0.114f * cos + 0.292f * sin;
-    mRotateHueData.colorMatrix[2][2] = 0.114f + 0.886f * cos - 0.203f * sin;
+    return runCachedFilter(CachedFilter::kRotateHue, radian, outputIndex,
+                           [this, outputIndex](float quantizedRadian) {
+                               return rotateHue(quantizedRadian, outputIndex, getImageRect());
+                           });
+}
+
+bool ImageProcessor::rotateHue(float radian, int outputIndex, const VkRect2D& damage) {
+    // Each output pixel only reads the input pixel at the same position.
+    const VkRect2D region = getDamagedRegion(damage, /*footprint=*/0, outputIndex);
+    if (region.extent.width == 0) return true;
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+
+    // Set HUE rotation matrix, shared with the CPU processor.
+    const cpu::ColorMatrix matrix = cpu::computeHueRotationMatrix(radian);
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) mRotateHueData.colorMatrix[i][j] = matrix[i][j];
+    }
+    mRotateHueData.offset[0] = region.offset.x;
+    mRotateHueData.offset[1] = region.offset.y;
 
     // Record command buffer and submit to queue
-    auto cmd = mCommandBuffer->handle();
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
     RET_CHECK(beginOneTimeCommandBuffer(cmd));
 
     // The storage image is used as an output storage image in the compute shader.
     mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
                                                        /*preserveData=*/false);
 
-    // Bind compute pipeline.
+    // Bind compute pipeline, and dispatch over the region only.
     mRotateHuePipeline->recordComputeCommands(cmd, &mRotateHueData, *mInputImage,
-                                              *mStagingOutputImage);
+                                              *mStagingOutputImage, nullptr,
+                                              /*descriptorSetIndex=*/0, region.extent);
+
+    // Copy the region of the staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex, region));
+    return true;
+}
 
-    // Prepare for image copying from the staging image to the output image.
-    mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+bool ImageProcessor::saturation(float saturation, int outputIndex) {
+    return runCachedFilter(CachedFilter::kSaturation, saturation, outputIndex,
+                           [this, outputIndex](float quantizedSaturation) {
+                               return this->saturation(quantizedSaturation, outputIndex,
+                                                       getImageRect());
+                           });
+}
 
-    // Copy staging image to output image.
-    recordImageCopyingCommand(cmd, *mStagingOutputImage, *mOutputImages[outputIndex]);
+bool ImageProcessor::saturation(float saturation, int outputIndex, const VkRect2D& damage) {
+    const VkRect2D region = getDamagedRegion(damage, /*footprint=*/0, outputIndex);
+    if (region.extent.width == 0) return true;
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+    mSaturationData.offset[0] = region.offset.x;
+    mSaturationData.offset[1] = region.offset.y;
+    mSaturationData.saturation = saturation;
 
-    // Submit to queue.
-    RET_CHECK(endAndSubmitCommandBuffer(cmd, mContext->queue()));
+    // Record command buffer and submit to queue
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+    mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
+                                                       /*preserveData=*/false);
+    mSaturationPipeline->recordComputeCommands(cmd, &mSaturationData, *mInputImage,
+                                               *mStagingOutputImage, nullptr,
+                                               /*descriptorSetIndex=*/0, region.extent);
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex, region));
     return true;
 }
 
 bool ImageProcessor::blur(float radius, int outputIndex) {
     RET_CHECK(1.0f <= radius && radius <= 25.0f);
+    return runCachedFilter(CachedFilter::kBlur, radius, outputIndex,
+                           [this, outputIndex](float quantizedRadius) {
+                               // The quantized radius may be just outside of the valid range.
+                               return blur(std::clamp(quantizedRadius, 1.0f, 25.0f), outputIndex,
+                                           getImageRect());
+                           });
+}
 
-    // Calculate gaussian kernel, this is equivalent to ComputeGaussianWeights at
-    // https://cs.android.com/android/platform/superproject/+/master:frameworks/rs/cpu_ref/rsCpuIntrinsicBlur.cpp;l=57
-    constexpr float e = 2.718281828459045f;
-    constexpr float pi = 3.1415926535897932f;
-    float sigma = 0.4f * radius + 0.6f;
-    float coeff1 = 1.0f / (std::sqrtf(2.0f * pi) * sigma);
-    float coeff2 = -1.0f / (2.0f * sigma * sigma);
-    int32_t iRadius = static_cast<int>(std::ceilf(radius));
-    float normalizeFactor = 0.0f;
-    for (int r = -iRadius; r <= iRadius; r++) {
-        const float value = coeff1 * std::powf(e, coeff2 * static_cast<float>(r * r));
-        mBlurData.kernel[r + iRadius] = value;
-        normalizeFactor += value;
-    }
-    normalizeFactor = 1.0f / normalizeFactor;
-    for (int r = -iRadius; r <= iRadius; r++) {
-        mBlurData.kernel[r + iRadius] *= normalizeFactor;
-    }
-    RET_CHECK(mBlurUniformBuffer->copyFrom(&mBlurData));
+bool ImageProcessor::blur(float radius, int outputIndex, const VkRect2D& damage) {
+    RET_CHECK(1.0f <= radius && radius <= 25.0f);
+
+    // Calculate gaussian kernel
+    const int32_t iRadius = cpu::computeGaussianKernel(radius, mBlurData.kernel);
+
+    // Each output pixel reads the input pixels within iRadius. The vertical pass reads iRadius
+    // rows of the horizontal pass above and below the region, so the horizontal pass covers them
+    // too.
+    const VkRect2D region = getDamagedRegion(damage, iRadius, outputIndex);
+    if (region.extent.width == 0) return true;
+    const VkRect2D horizontalRegion =
+            expandAndClipRect(region, /*marginX=*/0, /*marginY=*/iRadius, mInputImage->width(),
+                              mInputImage->height());
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+    Buffer* uniformBuffer = mFrames[mFrameIndex].blurUniformBuffer.get();
+    RET_CHECK(uniformBuffer->copyFrom(&mBlurData));
 
     // Apply a two-pass blur algorithm: a horizontal blur kernel followed by a vertical
     // blur kernel. This is equivalent to, but more efficient than applying a 2D blur
     // filter in a single pass. The two-pass blur algorithm has two kernels, each of
     // time complexity O(iRadius), while the single-pass algorithm has only one kernel,
     // but the time complexity is O(iRadius^2).
-    auto cmd = mCommandBuffer->handle();
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
     RET_CHECK(beginOneTimeCommandBuffer(cmd));
 
     // The temp image is used as an output storage image in the first pass.
     mTempImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL, /*preserveData=*/false);
 
     // First pass: apply a horizontal gaussian blur.
-    mBlurHorizontalPipeline->recordComputeCommands(cmd, &iRadius, *mInputImage, *mTempImage,
-                                                   mBlurUniformBuffer.get());
+    mBlurPassData = {{horizontalRegion.offset.x, horizontalRegion.offset.y}, iRadius};
+    mBlurHorizontalPipeline->recordComputeCommands(cmd, &mBlurPassData, *mInputImage, *mTempImage,
+                                                   uniformBuffer, /*descriptorSetIndex=*/0,
+                                                   horizontalRegion.extent);
 
     // The temp image is used as an input sampled image in the second pass,
     // and the staging image is used as an output storage image.
@@ -245,17 +891,232 @@ bool ImageProcessor::blur(float radius, int outputIndex) {
                                                        /*preserveData=*/false);
 
     // Second pass: apply a vertical gaussian blur.
-    mBlurVerticalPipeline->recordComputeCommands(cmd, &iRadius, *mTempImage, *mStagingOutputImage,
-                                                 mBlurUniformBuffer.get());
+    mBlurPassData = {{region.offset.x, region.offset.y}, iRadius};
+    mBlurVerticalPipeline->recordComputeCommands(cmd, &mBlurPassData, *mTempImage,
+                                                 *mStagingOutputImage, uniformBuffer,
+                                                 /*descriptorSetIndex=*/0, region.extent);
+
+    // Copy the region of the staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex, region));
+    return true;
+}
 
-    // Prepare for image copying from the staging image to the output image.
-    mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+void ImageProcessor::recordBoxBlurPass(VkCommandBuffer cmd, bool horizontal, int32_t radius,
+                                       uint32_t pass, Image* inputImage, Image* outputImage) {
+    // The input image is sampled, and the output image is used as an output storage image. The
+    // image content is preserved so that the barriers also guard against the previous pass.
+    inputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    outputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL);
 
-    // Copy staging image to output image.
-    recordImageCopyingCommand(cmd, *mStagingOutputImage, *mOutputImages[outputIndex]);
+    // Each invocation computes a segment of a row or a column.
+    mBoxBlurData.radius = radius;
+    mBoxBlurData.segmentLength = std::max(kMinBoxBlurSegmentLength, 2 * radius + 1);
+    const auto segmentLength = static_cast<uint32_t>(mBoxBlurData.segmentLength);
+    const uint32_t width = outputImage->width();
+    const uint32_t height = outputImage->height();
+    if (horizontal) {
+        const VkExtent2D dispatchExtent = {(width + segmentLength - 1) / segmentLength, height};
+        mBoxBlurHorizontalPipeline->recordComputeCommands(cmd, &mBoxBlurData, *inputImage,
+                                                          *outputImage, nullptr, pass,
+                                                          dispatchExtent);
+    } else {
+        const VkExtent2D dispatchExtent = {width, (height + segmentLength - 1) / segmentLength};
+        mBoxBlurVerticalPipeline->recordComputeCommands(cmd, &mBoxBlurData, *inputImage,
+                                                        *outputImage, nullptr, pass,
+                                                        dispatchExtent);
+    }
+}
+
+bool ImageProcessor::boxBlur(float radius, int outputIndex) {
+    RET_CHECK(1.0f <= radius && radius <= kMaxBoxBlurRadius);
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+    const auto iRadius = static_cast<int32_t>(std::ceilf(radius));
+
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+
+    // Apply a horizontal box blur followed by a vertical box blur.
+    recordBoxBlurPass(cmd, /*horizontal=*/true, iRadius, 0, mInputImage.get(), mTempImage);
+    recordBoxBlurPass(cmd, /*horizontal=*/false, iRadius, 0, mTempImage, mStagingOutputImage);
+
+    // Copy staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex));
+    return true;
+}
+
+bool ImageProcessor::stackedBoxBlur(float radius, int outputIndex) {
+    RET_CHECK(1.0f <= radius && radius <= kMaxBoxBlurRadius);
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+
+    // Use the same standard deviation as the gaussian kernel of ImageProcessor::blur.
+    const auto radii = cpu::computeStackedBoxRadii(0.4f * radius + 0.6f);
+
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+
+    // Apply the horizontal box blurs and then the vertical box blurs, ping-ponging between the
+    // two temp images. The last pass writes to the staging image.
+    Image* const pingPong[] = {mTempImage, mTempImage2};
+    Image* input = mInputImage.get();
+    uint32_t pass = 0;
+    for (const bool horizontal : {true, false}) {
+        for (uint32_t i = 0; i < cpu::kNumStackedBoxes; i++) {
+            const bool isLastPass = !horizontal && i + 1 == cpu::kNumStackedBoxes;
+            Image* output = isLastPass ? mStagingOutputImage : pingPong[pass % 2];
+            recordBoxBlurPass(cmd, horizontal, radii[i], i, input, output);
+            input = output;
+            pass++;
+        }
+    }
+
+    // Copy staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex));
+    return true;
+}
+
+bool ImageProcessor::pyramidBlur(float radius, float quality, int outputIndex) {
+    RET_CHECK(1.0f <= radius && radius <= kMaxPyramidBlurRadius);
+    RET_CHECK(0.0f <= quality && quality <= 1.0f);
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+    const PyramidBlurPlan plan = planPyramidBlur(radius, quality);
+    LOGV("Pyramid blur: radius = %f, levels = %u, residual radius = %f", radius, plan.levels,
+         plan.residualRadius);
+
+    // Calculate the gaussian kernel for the lowest level
+    int32_t iRadius = 0;
+    Buffer* uniformBuffer = mFrames[mFrameIndex].blurUniformBuffer.get();
+    if (plan.residualRadius > 0.0f) {
+        iRadius = cpu::computeGaussianKernel(plan.residualRadius, mBlurData.kernel);
+        RET_CHECK(uniformBuffer->copyFrom(&mBlurData));
+    }
+
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+
+    // Downsample the input image level by level.
+    Image* lowest = mInputImage.get();
+    for (uint32_t i = 0; i < plan.levels; i++) {
+        Image* output = mPyramidImages[i];
+        lowest->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        output->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL);
+        mPyramidDownsamplePipeline->recordComputeCommands(cmd, nullptr, *lowest, *output, nullptr,
+                                                          i, {output->width(), output->height()});
+        lowest = output;
+    }
+
+    // Apply the remaining blur at the lowest level with the two-pass gaussian blur. Without a
+    // pyramid, the second pass writes to the staging image directly.
+    if (iRadius > 0) {
+        Image* temp = plan.levels > 0 ? mPyramidTempImages[plan.levels - 1] : mTempImage;
+        Image* output = plan.levels > 0 ? lowest : mStagingOutputImage;
+        lowest->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        temp->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL);
+        mBlurPassData = {{0, 0}, iRadius};
+        mBlurHorizontalPipeline->recordComputeCommands(cmd, &mBlurPassData, *lowest, *temp,
+                                                       uniformBuffer);
+        temp->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        output->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL);
+        mBlurVerticalPipeline->recordComputeCommands(cmd, &mBlurPassData, *temp, *output,
+                                                     uniformBuffer);
+    }
+
+    // Upsample level by level. Each level image has been consumed by the downsample, so the
+    // upsampled result overwrites it. The last upsample writes to the staging image.
+    for (uint32_t i = plan.levels; i > 0; i--) {
+        Image* output = i > 1 ? mPyramidImages[i - 2] : mStagingOutputImage;
+        lowest->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        output->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL);
+        mPyramidUpsamplePipeline->recordComputeCommands(cmd, nullptr, *lowest, *output, nullptr,
+                                                        i - 1, {output->width(), output->height()});
+        lowest = output;
+    }
+
+    // Copy staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex));
+    return true;
+}
+
+bool ImageProcessor::histogram(uint32_t* histogram) {
+    RET_CHECK(histogram != nullptr);
+    RET_CHECK(beginFrame());
+
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+    mHistogramPipeline->recordComputeCommands(cmd, *mInputImage, *mHistogramBuffer);
+    RET_CHECK(endAndSubmitFrame(cmd));
+
+    // Wait for the command buffer to finish, and read back the histograms.
+    RET_CHECK(waitForCompletion());
+    RET_CHECK(mHistogramBuffer->copyTo(histogram));
+    return true;
+}
+
+bool ImageProcessor::lut(const uint8_t* red, const uint8_t* green, const uint8_t* blue,
+                         const uint8_t* alpha, int outputIndex) {
+    RET_CHECK(red != nullptr && green != nullptr && blue != nullptr && alpha != nullptr);
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+
+    // Interleave the lookup tables so that the shader reads a single entry per value.
+    for (uint32_t v = 0; v < kNumHistogramBins; v++) {
+        mLutData.table[v][0] = red[v];
+        mLutData.table[v][1] = green[v];
+        mLutData.table[v][2] = blue[v];
+        mLutData.table[v][3] = alpha[v];
+    }
+    Buffer* uniformBuffer = mFrames[mFrameIndex].lutUniformBuffer.get();
+    RET_CHECK(uniformBuffer->copyFrom(&mLutData));
+
+    // Record command buffer and submit to queue
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+
+    // The storage image is used as an output storage image in the compute shader.
+    mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
+                                                       /*preserveData=*/false);
+    mLutPipeline->recordComputeCommands(cmd, nullptr, *mInputImage, *mStagingOutputImage,
+                                        uniformBuffer);
+
+    // Copy staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex));
+    return true;
+}
+
+bool ImageProcessor::lut3D(const uint8_t* table, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ,
+                           int outputIndex) {
+    RET_CHECK(table != nullptr);
+    RET_CHECK(0 < sizeX && sizeX <= kMaxLut3DSize && 0 < sizeY && sizeY <= kMaxLut3DSize &&
+              0 < sizeZ && sizeZ <= kMaxLut3DSize);
+    RET_CHECK(beginFrame());
+    RET_CHECK(acquireTransientImages());
+
+    // Upload the lookup table if it has changed since the last call. The previous table may still
+    // be used by the pending commands.
+    const std::array<uint32_t, 3> size = {sizeX, sizeY, sizeZ};
+    const size_t tableSize = size_t{sizeX} * sizeY * sizeZ * 4;
+    if (mLut3D == nullptr || mLut3DSize != size ||
+        !std::equal(table, table + tableSize, mLut3DTable.begin())) {
+        RET_CHECK(waitForCompletion());
+        mLut3D = Lut3D::create(mContext.get(), table, sizeX, sizeY, sizeZ);
+        RET_CHECK(mLut3D != nullptr);
+        mLut3DTable.assign(table, table + tableSize);
+        mLut3DSize = size;
+    }
+
+    // Record command buffer and submit to queue
+    auto cmd = mFrames[mFrameIndex].commandBuffer->handle();
+    RET_CHECK(beginOneTimeCommandBuffer(cmd));
+
+    // The storage image is used as an output storage image in the compute shader.
+    mStagingOutputImage->recordLayoutTransitionBarrier(cmd, VK_IMAGE_LAYOUT_GENERAL,
+                                                       /*preserveData=*/false);
+    mLut3DPipeline->recordComputeCommands(cmd, *mInputImage, *mStagingOutputImage, *mLut3D);
 
-    // Submit to queue.
-    RET_CHECK(endAndSubmitCommandBuffer(cmd, mContext->queue()));
+    // Copy staging image to the output, and submit to queue.
+    RET_CHECK(recordOutputAndSubmit(cmd, outputIndex));
     return true;
 }
 
@@ -19,69 +19,368 @@
 
 #include <android/asset_manager_jni.h>
 #include <android/bitmap.h>
+#include <android/native_window.h>
 #include <jni.h>
 
+#include <array>
+#include <future>
 #include <memory>
+#include <vector>
 
 #include "ComputePipeline.h"
+#include "HistogramPipeline.h"
+#include "Lut3DPipeline.h"
+#include "ResizePipeline.h"
+#include "ResultCache.h"
+#include "Swapchain.h"
+#include "TransientAllocator.h"
 #include "VulkanContext.h"
 #include "VulkanResources.h"
+#include "cpu/ResizeTaps.h"
 
 namespace sample {
 
 class ImageProcessor {
    public:
-    // Create an image processor and initialize compute pipelines. If enableDebug is true,
-    // the Vulkan instance will be created with the validation layer "VK_LAYER_KHRONOS_validation".
-    // Return the created ImageProcessor on success, or nullptr if failed.
+    // Create an image processor and initialize compute pipelines. The image processors alive at the
+    // same time share a VulkanContext, each of them owns its pipelines, command buffers and images.
+    // If enableDebug is true, the Vulkan instance will be created with the validation layer
+    // "VK_LAYER_KHRONOS_validation". Return the created ImageProcessor on success, or nullptr if
+    // failed.
     static std::unique_ptr<ImageProcessor> create(bool enableDebug, AAssetManager* assetManager);
 
     // Prefer ImageProcessor::create
-    ImageProcessor() = default;
+    ImageProcessor() : mCommandPool(VK_NULL_HANDLE) {}
+
+    // Wait for the pending commands before releasing the resources they use.
+    ~ImageProcessor();
 
     // Create the input image from bitmap and allocate output images backed by AHardwareBuffers.
     bool configureInputAndOutput(JNIEnv* env, jobject inputBitmap, int numberOfOutputImages);
 
+    // Same as above, but resize the input bitmap to width x height with the given filter,
+    // equivalent to ScriptIntrinsicResize. The resize is done by a horizontal and a vertical
+    // compute pass, and the full resolution image is released afterwards, so the filters and the
+    // output images only ever work at the resized size.
+    bool configureInputAndOutput(JNIEnv* env, jobject inputBitmap, int numberOfOutputImages,
+                                 uint32_t width, uint32_t height, cpu::ResizeFilter filter);
+
+    // Block until the commands submitted by this processor have finished. The filters below return
+    // as soon as their commands are submitted, the output images must not be read before this
+    // returns. Each submission waits on the device for the previous one, and the host only waits
+    // when it reuses the command buffer of the filter kMaxFramesInFlight calls earlier.
+    bool waitForCompletion();
+
+    // Limit the device memory used by this processor to budget bytes, or 0 for no limit. The
+    // staging and intermediate images of the filters share one aliased allocation, which is
+    // cached together with the 3D lookup table. Whenever the memory usage exceeds the budget, the
+    // cached ones are released after the pending commands have finished, and are reallocated when
+    // needed again.
+    bool setMemoryBudget(uint64_t budget);
+
+    // Return the device memory in bytes allocated by this processor for its images.
+    uint64_t getMemoryUsage() const;
+
+    // Cache the results of rotateHue, saturation and blur over the whole image in at most budget
+    // bytes of device memory, or disable the cache if budget is 0. The parameters are quantized to
+    // multiples of step, and the filters compute with the quantized parameters, so that a filter
+    // repeated with a parameter within the same step, e.g. while scrubbing a slider, is served by
+    // a single copy of the cached result. The least recently used results are evicted first, and
+    // the results of a previous input image are dropped when the input changes.
+    bool setResultCache(uint64_t budget, float step);
+
+    // The output index of the filters to present the result to the output window instead of
+    // writing it to an output image.
+    static constexpr int kWindowOutput = -1;
+
+    // Present the filter results with the output index kWindowOutput to the window, e.g. for a
+    // live preview on a SurfaceView. The result is scaled to the window size and presented
+    // directly from the compute queue. The swapchain is kept across configureInputAndOutput, and
+    // recreated when the window is resized. Pass nullptr to release the window.
+    bool setOutputWindow(ANativeWindow* window);
+
+    // The number of output images of configureInputAndOutput.
+    int numOutputImages() const { return static_cast<int>(mOutputImages.size()); }
+
     // Get the managed AHardwareBuffer of the target output.
     AHardwareBuffer* getOutputAHardwareBuffer(int index) {
         return mOutputImages[index]->getAHardwareBuffer();
     }
 
+    // Copy the indexed output image to the host after the submitted filters, without waiting.
+    // Return a future resolving to the tightly packed RGBA_8888 pixels, or to nullptr if failed.
+    // The readbacks alternate between two persistently mapped buffers, so the caller may consume
+    // the pixels of the previous readback while the copy runs. The pixels stay valid until the
+    // readback after next, or until the images are reconfigured.
+    std::future<const uint8_t*> readback(int outputIndex);
+
+    // The size of the input and output images, or 0x0 before configureInputAndOutput.
+    VkExtent2D imageExtent() const;
+
     // Apply a filter to the input image and write the results to the indexed output image.
     bool rotateHue(float radian, int outputIndex);
     bool blur(float radius, int outputIndex);
 
+    // Mix each pixel with its luminance by the saturation, equivalent to saturation.rs of the
+    // BasicRenderScript sample. A saturation of 0 turns the image to grayscale, and 1 keeps it
+    // unchanged.
+    bool saturation(float saturation, int outputIndex);
+
+    // Copy the bitmap pixels within rect to the input image, e.g. after the user painted on the
+    // bitmap the input image was created from. The input image must not be resized, see
+    // configureInputAndOutput. Wait for the submitted filters first, as they may read the input.
+    bool updateInput(JNIEnv* env, jobject inputBitmap, const VkRect2D& rect);
+
+    // Same as the filters above, but only update the region of the indexed output image affected
+    // by the damaged rect of the input image, e.g. the rect of the last updateInput. The region is
+    // the damage expanded by the footprint of the filter, i.e. the radius for blur, and is the only
+    // part dispatched and copied, so the cost is proportional to its area. The rest of the output
+    // image keeps the previous result. The whole image is filtered for kWindowOutput, as the
+    // output window does not keep the previous result.
+    bool rotateHue(float radian, int outputIndex, const VkRect2D& damage);
+    bool saturation(float saturation, int outputIndex, const VkRect2D& damage);
+    bool blur(float radius, int outputIndex, const VkRect2D& damage);
+
+    // Blur filters with a cost per pixel independent of the radius, supporting a radius within
+    // the range of [1.0, 500.0]. boxBlur applies a single box filter, and stackedBoxBlur applies
+    // three box filters approximating the gaussian of blur with the same radius.
+    bool boxBlur(float radius, int outputIndex);
+    bool stackedBoxBlur(float radius, int outputIndex);
+
+    // Approximate the gaussian blur of ImageProcessor::blur with an image pyramid: the input image
+    // is repeatedly halved with a filtered downsample, blurred at the low resolution, and
+    // upsampled back. The radius must be within the range of [1.0, 500.0]. The quality within the
+    // range of [0.0, 1.0] trades speed for accuracy: a lower quality goes down more pyramid levels
+    // and leaves less of the blur to the gaussian kernel at the lowest level.
+    bool pyramidBlur(float radius, float quality, int outputIndex);
+
+    // Compute the per-channel histograms of the input image, equivalent to
+    // ScriptIntrinsicHistogram. The histogram must hold kHistogramSize elements, the count of value
+    // v in channel c (RGBA) is written to histogram[v * 4 + c].
+    bool histogram(uint32_t* histogram);
+
+    // Map each channel of the input image through a lookup table of 256 entries, equivalent to
+    // ScriptIntrinsicLUT.
+    bool lut(const uint8_t* red, const uint8_t* green, const uint8_t* blue, const uint8_t* alpha,
+             int outputIndex);
+
+    // Map the RGB color of the input image through a 3D lookup table with trilinear
+    // interpolation, equivalent to ScriptIntrinsic3DLUT. The alpha channel is preserved. See
+    // Lut3D::create for the layout of the table. Each size must be within [1, kMaxLut3DSize]. The
+    // table is only uploaded to the device if it differs from the table of the previous call.
+    bool lut3D(const uint8_t* table, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ,
+               int outputIndex);
+
    private:
     // Return true on success, false if initialization failed.
     bool initialize(bool enableDebug, AAssetManager* assetManager);
 
+    // Allocate the output images and the transient images with the size of the input image. Fail
+    // if the device does not have enough memory left in its budget.
+    bool allocateImages(int numberOfOutputImages);
+
+    // Declare the transient images and the steps of each filter using them, see
+    // TransientAllocator.
+    void declareTransientImages();
+
+    // Allocate the transient images if they have been released, and discard their content before
+    // recording a filter. Must be called by each filter using the transient images.
+    bool acquireTransientImages();
+
+    // Release all the images and readback buffers, which must not be used by pending commands.
+    void releaseImages();
+
+    // Advance to the next frame, wait for the previous submission of its command buffer, and
+    // select its descriptor sets in all the pipelines. Must be called by each filter before it
+    // writes the uniform buffers or records the command buffer of the frame.
+    bool beginFrame();
+
+    // End the command buffer of the current frame and submit it after the latest submission of
+    // this processor, without waiting on the host.
+    bool endAndSubmitFrame(VkCommandBuffer cmd,
+                           const VulkanContext::SubmitSemaphores& semaphores = {});
+
+    // Record the copy of the staging image to the indexed output image, or the presentation to the
+    // output window, end the command buffer and submit it. The memory budget is enforced after the
+    // submission, so that the resources acquired by any filter are accounted for.
+    bool recordOutputAndSubmit(VkCommandBuffer cmd, int outputIndex);
+
+    // Same as above, but only copy the region of the staging image to the output image. The
+    // region must be the whole image for kWindowOutput. The staging image is also copied to
+    // mResultCacheTarget if set.
+    bool recordOutputAndSubmit(VkCommandBuffer cmd, int outputIndex, const VkRect2D& region);
+
+    // Record the copy of the region of the source image to the indexed output image, or the
+    // presentation of the source image to the output window, end the command buffer and submit it.
+    bool recordCopyAndSubmit(VkCommandBuffer cmd, Image* sourceImage, int outputIndex,
+                             const VkRect2D& region);
+
+    // The filters whose results may be cached, see setResultCache.
+    enum class CachedFilter : uint32_t { kRotateHue, kSaturation, kBlur };
+
+    // Copy the cached result of the filter with the quantized parameter to the output, or call
+    // run with the quantized parameter to compute the result over the whole image, and keep a
+    // copy of it in the cache. Call run with the parameter as is if the cache is disabled.
+    template <typename Filter>
+    bool runCachedFilter(CachedFilter filter, float parameter, int outputIndex, Filter run);
+
+    // Return the rect of the whole input image.
+    VkRect2D getImageRect() const;
+
+    // Return the region of the output image affected by the damaged rect of the input image, i.e.
+    // the damage expanded by footprint pixels on each side and clipped to the image, or the whole
+    // image for kWindowOutput. The region is empty if the damage is outside of the image.
+    VkRect2D getDamagedRegion(const VkRect2D& damage, int32_t footprint, int outputIndex) const;
+
+    // Record the copy of the indexed output image to the next readback buffer and submit it.
+    // Return the host address of the buffer and the submission to wait for.
+    bool submitReadback(int outputIndex, const uint8_t** data, uint64_t* submission);
+
+    // Release the cached 3D lookup table and transient images, until the memory usage is within
+    // the budget.
+    bool enforceMemoryBudget();
+
+    // Resize the source image to width x height into a new input image.
+    bool resizeInput(const Image& sourceImage, uint32_t width, uint32_t height,
+                     cpu::ResizeFilter filter);
+
+    // Record a horizontal or vertical sliding window box blur pass from the input image to the
+    // output image. Each pass recorded into the same command buffer must use a distinct pass
+    // index, which selects the descriptor set of the pipeline.
+    void recordBoxBlurPass(VkCommandBuffer cmd, bool horizontal, int32_t radius, uint32_t pass,
+                           Image* inputImage, Image* outputImage);
+
     // Context
-    std::unique_ptr<VulkanContext> mContext;
+    std::shared_ptr<VulkanContext> mContext;
 
     // Images
     std::unique_ptr<Image> mInputImage;
-    std::unique_ptr<Image> mStagingOutputImage;
     std::vector<std::unique_ptr<Image>> mOutputImages;
-    std::unique_ptr<Image> mTempImage;
 
-    // Command buffer
-    std::unique_ptr<VulkanCommandBuffer> mCommandBuffer;
+    // The swapchain of the output window, or nullptr if there is no output window.
+    std::unique_ptr<Swapchain> mSwapchain;
+
+    // The budget of the device memory used by the images, 0 for no limit.
+    uint64_t mMemoryBudget = 0;
+
+    // The results of the previous filters, or nullptr if the cache is disabled. The generation of
+    // the input image is part of the keys, and changes whenever the input image is updated. The
+    // target is the cache image receiving the result of the filter being recorded, or nullptr.
+    std::unique_ptr<ResultCache> mResultCache;
+    uint64_t mInputGeneration = 0;
+    Image* mResultCacheTarget = nullptr;
+
+    // The staging and intermediate images are only used within the command buffer of a filter,
+    // and are owned by the transient allocator. The pointers below are refreshed by
+    // ImageProcessor::acquireTransientImages, and are nullptr while the images are released.
+    std::unique_ptr<TransientAllocator> mTransientAllocator;
+    struct {
+        uint32_t stagingOutput = 0;
+        uint32_t temp = 0;
+        uint32_t temp2 = 0;
+        std::vector<uint32_t> pyramid;
+        std::vector<uint32_t> pyramidTemp;
+    } mTransientIndices;
+    Image* mStagingOutputImage = nullptr;
+    Image* mTempImage = nullptr;
+    Image* mTempImage2 = nullptr;
+
+    // Images of the blur pyramid, the level i image has half the size of the level i - 1 image.
+    // The full resolution level 0 is not included. The temp images are used by the gaussian blur
+    // at the lowest level.
+    std::vector<Image*> mPyramidImages;
+    std::vector<Image*> mPyramidTempImages;
+
+    // Command pool and the timeline value of the latest submission of this processor. An
+    // ImageProcessor is used by one thread at a time, so it owns its pool rather than using the
+    // pool of the initializing thread, and waits for its own submissions only.
+    VulkanCommandPool mCommandPool;
+    uint64_t mLastSubmission = 0;
+
+    // The command buffer and the uniform buffers written by a filter, which must not be modified
+    // while the filter is pending. The filters cycle through kMaxFramesInFlight frames, together
+    // with the descriptor sets of the pipelines, see ImageProcessor::beginFrame.
+    struct Frame {
+        std::unique_ptr<VulkanCommandBuffer> commandBuffer;
+        std::unique_ptr<Buffer> blurUniformBuffer;
+        std::unique_ptr<Buffer> lutUniformBuffer;
+        uint64_t submission = 0;
+    };
+    std::array<Frame, kMaxFramesInFlight> mFrames;
+    uint32_t mFrameIndex = 0;
+
+    // Host-visible buffers for the output readback, allocated on first use. Each of them has its
+    // own command buffer, so that a readback is recorded while the previous one is pending.
+    static constexpr uint32_t kNumReadbackBuffers = 2;
+    struct ReadbackBuffer {
+        std::unique_ptr<Buffer> buffer;
+        std::unique_ptr<VulkanCommandBuffer> commandBuffer;
+        uint64_t submission = 0;
+    };
+    std::array<ReadbackBuffer, kNumReadbackBuffers> mReadbackBuffers;
+    uint32_t mNextReadbackBuffer = 0;
 
     // Compute pipeline and uniform buffer for HUE rotation
     struct {
         // A 3x3 matrix (mat3), each row is aligned to vec4.
         float colorMatrix[3][4] = {};
+        // The offset of the filtered region.
+        int32_t offset[2] = {};
     } mRotateHueData;
     std::unique_ptr<ComputePipeline> mRotateHuePipeline;
 
-    // Compute pipelines and uniform buffer for blur
+    // Compute pipeline for saturation
+    struct {
+        int32_t offset[2] = {};
+        float saturation = 0.0f;
+    } mSaturationData;
+    std::unique_ptr<ComputePipeline> mSaturationPipeline;
+
+    // Compute pipelines and uniform data for blur
     struct {
         // A float array of length 52.
         float kernel[52] = {};
     } mBlurData;
-    std::unique_ptr<Buffer> mBlurUniformBuffer;
+    struct {
+        int32_t offset[2] = {};
+        int32_t radius = 0;
+    } mBlurPassData;
     std::unique_ptr<ComputePipeline> mBlurHorizontalPipeline;
     std::unique_ptr<ComputePipeline> mBlurVerticalPipeline;
+
+    // Compute pipelines for box blur
+    struct {
+        int32_t radius = 0;
+        int32_t segmentLength = 0;
+    } mBoxBlurData;
+    std::unique_ptr<ComputePipeline> mBoxBlurHorizontalPipeline;
+    std::unique_ptr<ComputePipeline> mBoxBlurVerticalPipeline;
+
+    // Compute pipelines for pyramid blur
+    std::unique_ptr<ComputePipeline> mPyramidDownsamplePipeline;
+    std::unique_ptr<ComputePipeline> mPyramidUpsamplePipeline;
+
+    // Compute pipeline and storage buffer for histogram
+    std::unique_ptr<Buffer> mHistogramBuffer;
+    std::unique_ptr<HistogramPipeline> mHistogramPipeline;
+
+    // Compute pipeline and uniform data for LUT
+    struct {
+        // The entry v holds the mapped value of v for each of the RGBA channels.
+        uint32_t table[256][4] = {};
+    } mLutData;
+    std::unique_ptr<ComputePipeline> mLutPipeline;
+
+    // Compute pipeline and lookup table for 3D LUT. A copy of the table is kept on the host to
+    // detect whether the table has changed.
+    std::vector<uint8_t> mLut3DTable;
+    std::array<uint32_t, 3> mLut3DSize = {};
+    std::unique_ptr<Lut3D> mLut3D;
+    std::unique_ptr<Lut3DPipeline> mLut3DPipeline;
+
+    // Compute pipelines for resizing the input image
+    std::unique_ptr<ResizePipeline> mResizeHorizontalPipeline;
+    std::unique_ptr<ResizePipeline> mResizeVerticalPipeline;
 };
 
 }  // namespace sample
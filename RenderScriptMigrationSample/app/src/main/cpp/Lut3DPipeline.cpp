@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Lut3DPipeline.h"
+
+#include <android/asset_manager_jni.h>
+
+#include <vector>
+
+#include "Utils.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+std::unique_ptr<Lut3DPipeline> Lut3DPipeline::create(const VulkanContext* context,
+                                                     AAssetManager* assetManager) {
+    auto pipeline = std::make_unique<Lut3DPipeline>(context);
+    const bool success = pipeline->createDescriptorSets() &&
+                         pipeline->createComputePipeline("shaders/Lut3D.comp.spv", assetManager);
+    return success ? std::move(pipeline) : nullptr;
+}
+
+bool Lut3DPipeline::createDescriptorSets() {
+    const std::vector<VkDescriptorSetLayoutBinding> descriptorsetLayoutBinding = {
+            {
+                    .binding = 0,  // input image
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                    .binding = 1,  // output image
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                    .binding = 2,  // lookup table
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+    };
+    return ComputePipeline::createDescriptorSets(descriptorsetLayoutBinding,
+                                                 /*numDescriptorSets=*/1);
+}
+
+void Lut3DPipeline::recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                                          const Image& outputImage, const Lut3D& lut) {
+    // Update descriptor sets with input and output images and the lookup table
+    const auto inputImageInfo = inputImage.getDescriptor();
+    const auto outputImageInfo = outputImage.getDescriptor();
+    const auto lutInfo = lut.getDescriptor();
+    const std::vector<VkWriteDescriptorSet> writeDescriptorSet = {
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo = &inputImageInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .pImageInfo = &outputImageInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 2,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo = &lutInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+    };
+    vkUpdateDescriptorSets(mContext->device(), static_cast<uint32_t>(writeDescriptorSet.size()),
+                           writeDescriptorSet.data(), 0, nullptr);
+
+    recordDispatch(cmd, nullptr, 0, {outputImage.width(), outputImage.height()});
+}
+
+}  // namespace sample
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_LUT3D_PIPELINE_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_LUT3D_PIPELINE_H
+
+#include <android/asset_manager_jni.h>
+#include <vulkan/vulkan_core.h>
+
+#include <memory>
+
+#include "ComputePipeline.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+// The maximum size of each dimension of the 3D lookup tables, within the minimum
+// maxImageDimension3D guaranteed by Vulkan.
+constexpr uint32_t kMaxLut3DSize = 256;
+
+// Lut3DPipeline maps the colors of a 2D image through a 3D lookup table. The lookup table is
+// bound as a 3D image in addition to the input and output images, and the trilinear interpolation
+// between the table entries is done by the sampler.
+class Lut3DPipeline : public ComputePipeline {
+   public:
+    // Create a 3D LUT pipeline.
+    // Return the created Lut3DPipeline on success, or nullptr if failed.
+    static std::unique_ptr<Lut3DPipeline> create(const VulkanContext* context,
+                                                 AAssetManager* assetManager);
+
+    // Prefer Lut3DPipeline::create
+    explicit Lut3DPipeline(const VulkanContext* context)
+        : ComputePipeline(context, /*pushConstantSize=*/0) {}
+
+    // Record the compute pipeline to the command buffer with the given lookup table and
+    // input/output image.
+    void recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                               const Image& outputImage, const Lut3D& lut);
+
+   private:
+    // Initialization
+    bool createDescriptorSets();
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_LUT3D_PIPELINE_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResizePipeline.h"
+
+#include <android/asset_manager_jni.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Utils.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+#include "cpu/ResizeTaps.h"
+
+namespace sample {
+
+std::unique_ptr<ResizePipeline> ResizePipeline::create(const VulkanContext* context,
+                                                       const char* shader,
+                                                       AAssetManager* assetManager) {
+    auto pipeline = std::make_unique<ResizePipeline>(context);
+    const bool success = pipeline->createDescriptorSets() &&
+                         pipeline->createComputePipeline(shader, assetManager);
+    return success ? std::move(pipeline) : nullptr;
+}
+
+std::unique_ptr<Buffer> ResizePipeline::createTapBuffer(const VulkanContext* context,
+                                                        const cpu::ResizeTaps& taps) {
+    // The start indices are exactly representable as floats for any image dimension.
+    const size_t stride = taps.numTaps + 1;
+    std::vector<float> data(taps.starts.size() * stride);
+    for (size_t i = 0; i < taps.starts.size(); i++) {
+        data[i * stride] = static_cast<float>(taps.starts[i]);
+        std::copy_n(taps.weights.begin() + static_cast<ptrdiff_t>(i * taps.numTaps), taps.numTaps,
+                    data.begin() + static_cast<ptrdiff_t>(i * stride + 1));
+    }
+    auto buffer = Buffer::create(
+            context, static_cast<uint32_t>(data.size() * sizeof(float)),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (buffer == nullptr || !buffer->copyFrom(data.data())) return nullptr;
+    return buffer;
+}
+
+bool ResizePipeline::createDescriptorSets() {
+    const std::vector<VkDescriptorSetLayoutBinding> descriptorsetLayoutBinding = {
+            {
+                    .binding = 0,  // input image
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                    .binding = 1,  // output image
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                    .binding = 2,  // taps
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+    };
+    return ComputePipeline::createDescriptorSets(descriptorsetLayoutBinding,
+                                                 /*numDescriptorSets=*/1);
+}
+
+void ResizePipeline::recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                                           const Image& outputImage, const Buffer& tapBuffer,
+                                           uint32_t numTaps) {
+    // Update descriptor sets with input and output images and the tap buffer
+    const auto inputImageInfo = inputImage.getDescriptor();
+    const auto outputImageInfo = outputImage.getDescriptor();
+    const auto tapInfo = tapBuffer.getDescriptor();
+    const std::vector<VkWriteDescriptorSet> writeDescriptorSet = {
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 0,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo = &inputImageInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 1,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .pImageInfo = &outputImageInfo,
+                    .pBufferInfo = nullptr,
+                    .pTexelBufferView = nullptr,
+            },
+            {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = getDescriptorSet(0),
+                    .dstBinding = 2,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pImageInfo = nullptr,
+                    .pBufferInfo = &tapInfo,
+                    .pTexelBufferView = nullptr,
+            },
+    };
+    vkUpdateDescriptorSets(mContext->device(), static_cast<uint32_t>(writeDescriptorSet.size()),
+                           writeDescriptorSet.data(), 0, nullptr);
+
+    const auto numTapsConstant = static_cast<int32_t>(numTaps);
+    recordDispatch(cmd, &numTapsConstant, 0, {outputImage.width(), outputImage.height()});
+}
+
+}  // namespace sample
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_RESIZE_PIPELINE_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_RESIZE_PIPELINE_H
+
+#include <android/asset_manager_jni.h>
+#include <vulkan/vulkan_core.h>
+
+#include <memory>
+
+#include "ComputePipeline.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+#include "cpu/ResizeTaps.h"
+
+namespace sample {
+
+// ResizePipeline resizes a 2D image along one axis with precomputed filter taps. A 2D resize is
+// a horizontal pass followed by a vertical pass, each with its own pipeline and tap buffer.
+class ResizePipeline : public ComputePipeline {
+   public:
+    // Create a resize pipeline with the input shader.
+    // Return the created ResizePipeline on success, or nullptr if failed.
+    static std::unique_ptr<ResizePipeline> create(const VulkanContext* context, const char* shader,
+                                                  AAssetManager* assetManager);
+
+    // Prefer ResizePipeline::create
+    explicit ResizePipeline(const VulkanContext* context)
+        : ComputePipeline(context, sizeof(int32_t)) {}
+
+    // Create a host-visible storage buffer holding the taps in the layout of the resize shaders:
+    // for each output pixel, the start index as a float followed by taps.numTaps weights.
+    static std::unique_ptr<Buffer> createTapBuffer(const VulkanContext* context,
+                                                   const cpu::ResizeTaps& taps);
+
+    // Record the compute pipeline to the command buffer with the given tap buffer and
+    // input/output image.
+    void recordComputeCommands(VkCommandBuffer cmd, const Image& inputImage,
+                               const Image& outputImage, const Buffer& tapBuffer,
+                               uint32_t numTaps);
+
+   private:
+    // Initialization
+    bool createDescriptorSets();
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_RESIZE_PIPELINE_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResultCache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+
+#include "Utils.h"
+
+namespace sample {
+
+std::unique_ptr<ResultCache> ResultCache::create(const VulkanContext* context, uint64_t budget,
+                                                 float step) {
+    // The comparison also rejects a NaN step.
+    if (budget == 0 || !(step > 0.0f)) {
+        LOGE("ResultCache::create: Invalid budget %" PRIu64 " or step %f", budget,
+             static_cast<double>(step));
+        return nullptr;
+    }
+    return std::make_unique<ResultCache>(context, budget, step);
+}
+
+int64_t ResultCache::quantize(float value) const {
+    const double index = static_cast<double>(value) / static_cast<double>(mStep);
+    return static_cast<int64_t>(std::llround(index));
+}
+
+Image* ResultCache::find(const Key& key) {
+    const auto it = std::find_if(mEntries.begin(), mEntries.end(),
+                                 [&key](const Entry& entry) { return entry.key == key; });
+    if (it == mEntries.end()) return nullptr;
+    mEntries.splice(mEntries.begin(), mEntries, it);
+    return mEntries.front().image.get();
+}
+
+bool ResultCache::needsEviction(uint32_t width, uint32_t height) const {
+    if (mEntries.empty()) return false;
+
+    // The images created with the same size have the same memory requirements. Assume the worst
+    // for another size.
+    const Image& image = *mEntries.front().image;
+    if (image.width() != width || image.height() != height) return true;
+    return mMemorySize + image.memorySize() > mBudget;
+}
+
+Image* ResultCache::insert(const Key& key, uint32_t width, uint32_t height) {
+    erase(key);
+
+    // Evict with the estimated size before allocating, so that the evicted memory can be reused,
+    // and again with the actual size, which includes the alignment of the allocation.
+    const uint64_t estimatedSize = uint64_t{width} * height * 4;
+    if (estimatedSize > mBudget) return nullptr;
+    evictFor(estimatedSize);
+
+    // The image view created with the image needs a usage other than the transfers.
+    auto image = Image::createDeviceLocal(mContext, width, height,
+                                          VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                                  VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                                  VK_IMAGE_USAGE_SAMPLED_BIT);
+    if (image == nullptr) return nullptr;
+    const uint64_t size = image->memorySize();
+    if (size > mBudget) return nullptr;
+    evictFor(size);
+    mMemorySize += size;
+    mEntries.push_front({key, std::move(image)});
+    return mEntries.front().image.get();
+}
+
+void ResultCache::erase(const Key& key) {
+    const auto it = std::find_if(mEntries.begin(), mEntries.end(),
+                                 [&key](const Entry& entry) { return entry.key == key; });
+    if (it == mEntries.end()) return;
+    mMemorySize -= it->image->memorySize();
+    mEntries.erase(it);
+}
+
+void ResultCache::eraseStale(uint64_t inputGeneration) {
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->key.inputGeneration == inputGeneration) {
+            ++it;
+            continue;
+        }
+        mMemorySize -= it->image->memorySize();
+        it = mEntries.erase(it);
+    }
+}
+
+void ResultCache::clear() {
+    mEntries.clear();
+    mMemorySize = 0;
+}
+
+void ResultCache::evictFor(uint64_t size) {
+    while (!mEntries.empty() && mMemorySize + size > mBudget) {
+        mMemorySize -= mEntries.back().image->memorySize();
+        mEntries.pop_back();
+    }
+}
+
+}  // namespace sample
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_RESULT_CACHE_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_RESULT_CACHE_H
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+// ResultCache keeps filter results in device images, so that a filter requested again with the
+// same input and parameters is served by a copy instead of being recomputed, e.g. while the user
+// scrubs a slider back and forth. The parameters are quantized to a step, so that nearby values
+// share a result. The images are bounded by a byte budget, and the least recently used results
+// are evicted first.
+//
+// The cache does not synchronize with the device: the caller must make sure that the images
+// evicted by ResultCache::insert, ResultCache::erase and friends are not used by pending commands.
+class ResultCache {
+   public:
+    struct Key {
+        // The generation of the input image, changed whenever the input image is updated.
+        uint64_t inputGeneration;
+        // The filter chain producing the result.
+        uint32_t filter;
+        // The parameter of the filter, quantized with ResultCache::quantize.
+        int64_t parameter;
+
+        bool operator==(const Key& other) const {
+            return inputGeneration == other.inputGeneration && filter == other.filter &&
+                   parameter == other.parameter;
+        }
+    };
+
+    // Create a cache of at most budget bytes, quantizing the parameters to multiples of step.
+    // Return nullptr if the budget is 0 or the step is not positive.
+    static std::unique_ptr<ResultCache> create(const VulkanContext* context, uint64_t budget,
+                                               float step);
+
+    // Prefer ResultCache::create
+    ResultCache(const VulkanContext* context, uint64_t budget, float step)
+        : mContext(context), mBudget(budget), mStep(step) {}
+
+    // Return the index of the multiple of the step closest to value, and the value of the index.
+    int64_t quantize(float value) const;
+    float dequantize(int64_t index) const { return static_cast<float>(index) * mStep; }
+
+    // Return the cached result of the key and mark it as the most recently used, or nullptr if
+    // the result is not cached.
+    Image* find(const Key& key);
+
+    // Return true if ResultCache::insert of a result of width x height may evict other results,
+    // i.e. if the caller must wait for the pending commands using the cached images first.
+    bool needsEviction(uint32_t width, uint32_t height) const;
+
+    // Create an image of width x height for the result of the key, evicting the least recently
+    // used results as needed to stay within the budget. The image is created with
+    // VK_IMAGE_USAGE_TRANSFER_SRC_BIT and VK_IMAGE_USAGE_TRANSFER_DST_BIT, and its content is
+    // undefined until the caller writes the result. Return nullptr if the image alone exceeds the
+    // budget or cannot be allocated.
+    Image* insert(const Key& key, uint32_t width, uint32_t height);
+
+    // Remove the result of the key if cached, e.g. if the filter failed to write it.
+    void erase(const Key& key);
+
+    // Remove the results of the input generations other than inputGeneration.
+    void eraseStale(uint64_t inputGeneration);
+
+    // Remove all the results.
+    void clear();
+
+    // Return the size in bytes of the device memory of the cached images.
+    uint64_t memorySize() const { return mMemorySize; }
+
+   private:
+    struct Entry {
+        Key key;
+        std::unique_ptr<Image> image;
+    };
+
+    // Evict the least recently used results until size more bytes fit within the budget.
+    void evictFor(uint64_t size);
+
+    const VulkanContext* mContext;
+    const uint64_t mBudget;
+    const float mStep;
+
+    // The cached results, from the most to the least recently used. A budget only holds a few
+    // full size images, so the lookup is a linear search.
+    std::list<Entry> mEntries;
+    uint64_t mMemorySize = 0;
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_RESULT_CACHE_H
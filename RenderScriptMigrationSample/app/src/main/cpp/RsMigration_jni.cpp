@@ -18,9 +18,16 @@
 #include <android/bitmap.h>
 #include <android/hardware_buffer_jni.h>
 #include <android/log.h>
+#include <android/native_window_jni.h>
 #include <jni.h>
 
+#include <array>
+#include <cstring>
+#include <future>
+
+#include "CommandList.h"
 #include "ImageProcessor.h"
+#include "cpu/ImageProcessor.h"
 
 namespace {
 
@@ -30,6 +37,66 @@ ImageProcessor* castToImageProcessor(jlong handle) {
     return reinterpret_cast<ImageProcessor*>(static_cast<uintptr_t>(handle));
 }
 
+// A pending readback, and the size of the image read back.
+struct Readback {
+    std::future<const uint8_t*> pixels;
+    VkExtent2D extent;
+};
+
+Readback* castToReadback(jlong handle) {
+    return reinterpret_cast<Readback*>(static_cast<uintptr_t>(handle));
+}
+
+// Copy the width x height RGBA_8888 pixels into the bitmap, which must have the same size. The rows
+// of the pixels are stride bytes apart, or tightly packed if stride is 0.
+bool copyToBitmap(JNIEnv* env, const uint8_t* pixels, uint32_t width, uint32_t height,
+                  size_t stride, jobject bitmap) {
+    AndroidBitmapInfo info;
+    RET_CHECK(AndroidBitmap_getInfo(env, bitmap, &info) == ANDROID_BITMAP_RESULT_SUCCESS);
+    RET_CHECK(info.format == ANDROID_BITMAP_FORMAT_RGBA_8888);
+    RET_CHECK(info.width == width && info.height == height);
+    void* bitmapPixels = nullptr;
+    RET_CHECK(AndroidBitmap_lockPixels(env, bitmap, &bitmapPixels) ==
+              ANDROID_BITMAP_RESULT_SUCCESS);
+    const size_t rowSize = size_t{info.width} * 4;
+    const size_t pixelsStride = stride != 0 ? stride : rowSize;
+    for (size_t y = 0; y < info.height; y++) {
+        memcpy(static_cast<uint8_t*>(bitmapPixels) + y * info.stride, pixels + y * pixelsStride,
+               rowSize);
+    }
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return true;
+}
+
+// Convert the bounds of an android.graphics.Rect to a VkRect2D. Return false if the rect is
+// inverted.
+bool toVkRect2D(jint left, jint top, jint right, jint bottom, VkRect2D* rect) {
+    RET_CHECK(left <= right && top <= bottom);
+    *rect = {{left, top},
+             {static_cast<uint32_t>(int64_t{right} - left),
+              static_cast<uint32_t>(int64_t{bottom} - top)}};
+    return true;
+}
+
+using CpuImageProcessor = sample::cpu::ImageProcessor;
+
+CpuImageProcessor* castToCpuImageProcessor(jlong handle) {
+    return reinterpret_cast<CpuImageProcessor*>(static_cast<uintptr_t>(handle));
+}
+
+// Apply a filter of the CPU processor, and copy the indexed output image to the bitmap.
+template <typename Filter>
+bool runCpuFilter(JNIEnv* env, jlong processor, jint outputIndex, jobject outputBitmap,
+                  Filter filter) {
+    if (processor == 0L) return false;
+    auto* cpuProcessor = castToCpuImageProcessor(processor);
+    RET_CHECK(filter(cpuProcessor));
+    const sample::cpu::BitmapView output = cpuProcessor->getOutputImage(outputIndex);
+    RET_CHECK(output.pixels != nullptr);
+    return copyToBitmap(env, output.pixels, output.width, output.height, output.stride,
+                        outputBitmap);
+}
+
 }  // namespace
 
 extern "C" JNIEXPORT jlong JNICALL
@@ -44,10 +111,14 @@ Java_com_android_example_rsmigration_VulkanImageProcessor_initVulkanProcessor(
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_android_example_rsmigration_VulkanImageProcessor_configureInputAndOutput(
         JNIEnv* env, jobject /* this */, jlong _processor, jobject _inputBitmap,
-        jint _numberOfOutputImages) {
+        jint _numberOfOutputImages, jint _width, jint _height, jint _resizeFilter) {
     if (_processor == 0L) return false;
+    RET_CHECK(_width > 0 && _height > 0);
+    RET_CHECK(_resizeFilter >= static_cast<jint>(sample::cpu::ResizeFilter::kBilinear) &&
+              _resizeFilter <= static_cast<jint>(sample::cpu::ResizeFilter::kLanczos));
     return castToImageProcessor(_processor)
-            ->configureInputAndOutput(env, _inputBitmap, _numberOfOutputImages);
+            ->configureInputAndOutput(env, _inputBitmap, _numberOfOutputImages, _width, _height,
+                                      static_cast<sample::cpu::ResizeFilter>(_resizeFilter));
 }
 
 extern "C" JNIEXPORT jobject JNICALL
@@ -68,6 +139,16 @@ Java_com_android_example_rsmigration_VulkanImageProcessor_rotateHue(JNIEnv* /* e
     return castToImageProcessor(_processor)->rotateHue(_radian, _outputIndex);
 }
 
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_saturation(JNIEnv* /* env */,
+                                                                     jobject /* this */,
+                                                                     jlong _processor,
+                                                                     jfloat _saturation,
+                                                                     jint _outputIndex) {
+    if (_processor == 0L) return false;
+    return castToImageProcessor(_processor)->saturation(_saturation, _outputIndex);
+}
+
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_android_example_rsmigration_VulkanImageProcessor_blur(JNIEnv* /* env */,
                                                                jobject /* this */, jlong _processor,
@@ -76,6 +157,218 @@ Java_com_android_example_rsmigration_VulkanImageProcessor_blur(JNIEnv* /* env */
     return castToImageProcessor(_processor)->blur(_radius, _outputIndex);
 }
 
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_updateInput(
+        JNIEnv* env, jobject /* this */, jlong _processor, jobject _inputBitmap, jint _left,
+        jint _top, jint _right, jint _bottom) {
+    if (_processor == 0L) return false;
+    VkRect2D rect;
+    RET_CHECK(toVkRect2D(_left, _top, _right, _bottom, &rect));
+    return castToImageProcessor(_processor)->updateInput(env, _inputBitmap, rect);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_rotateHueDamaged(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jfloat _radian, jint _outputIndex,
+        jint _left, jint _top, jint _right, jint _bottom) {
+    if (_processor == 0L) return false;
+    VkRect2D damage;
+    RET_CHECK(toVkRect2D(_left, _top, _right, _bottom, &damage));
+    return castToImageProcessor(_processor)->rotateHue(_radian, _outputIndex, damage);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_saturationDamaged(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jfloat _saturation,
+        jint _outputIndex, jint _left, jint _top, jint _right, jint _bottom) {
+    if (_processor == 0L) return false;
+    VkRect2D damage;
+    RET_CHECK(toVkRect2D(_left, _top, _right, _bottom, &damage));
+    return castToImageProcessor(_processor)->saturation(_saturation, _outputIndex, damage);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_blurDamaged(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jfloat _radius, jint _outputIndex,
+        jint _left, jint _top, jint _right, jint _bottom) {
+    if (_processor == 0L) return false;
+    VkRect2D damage;
+    RET_CHECK(toVkRect2D(_left, _top, _right, _bottom, &damage));
+    return castToImageProcessor(_processor)->blur(_radius, _outputIndex, damage);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_boxBlur(JNIEnv* /* env */,
+                                                                  jobject /* this */,
+                                                                  jlong _processor, jfloat _radius,
+                                                                  jint _outputIndex) {
+    if (_processor == 0L) return false;
+    return castToImageProcessor(_processor)->boxBlur(_radius, _outputIndex);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_stackedBoxBlur(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jfloat _radius,
+        jint _outputIndex) {
+    if (_processor == 0L) return false;
+    return castToImageProcessor(_processor)->stackedBoxBlur(_radius, _outputIndex);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_pyramidBlur(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jfloat _radius, jfloat _quality,
+        jint _outputIndex) {
+    if (_processor == 0L) return false;
+    return castToImageProcessor(_processor)->pyramidBlur(_radius, _quality, _outputIndex);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_histogram(JNIEnv* env,
+                                                                    jobject /* this */,
+                                                                    jlong _processor,
+                                                                    jintArray _histogram) {
+    if (_processor == 0L) return false;
+    RET_CHECK(env->GetArrayLength(_histogram) == static_cast<jsize>(sample::kHistogramSize));
+    std::array<uint32_t, sample::kHistogramSize> histogram;
+    RET_CHECK(castToImageProcessor(_processor)->histogram(histogram.data()));
+    env->SetIntArrayRegion(_histogram, 0, sample::kHistogramSize,
+                           reinterpret_cast<const jint*>(histogram.data()));
+    return true;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_android_example_rsmigration_VulkanImageProcessor_lut(
+        JNIEnv* env, jobject /* this */, jlong _processor, jbyteArray _red, jbyteArray _green,
+        jbyteArray _blue, jbyteArray _alpha, jint _outputIndex) {
+    if (_processor == 0L) return false;
+    std::array<std::array<jbyte, sample::kNumHistogramBins>, 4> tables;
+    const jbyteArray arrays[] = {_red, _green, _blue, _alpha};
+    for (size_t i = 0; i < tables.size(); i++) {
+        RET_CHECK(env->GetArrayLength(arrays[i]) == static_cast<jsize>(sample::kNumHistogramBins));
+        env->GetByteArrayRegion(arrays[i], 0, sample::kNumHistogramBins, tables[i].data());
+    }
+    return castToImageProcessor(_processor)
+            ->lut(reinterpret_cast<const uint8_t*>(tables[0].data()),
+                  reinterpret_cast<const uint8_t*>(tables[1].data()),
+                  reinterpret_cast<const uint8_t*>(tables[2].data()),
+                  reinterpret_cast<const uint8_t*>(tables[3].data()), _outputIndex);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_lut3D(
+        JNIEnv* env, jobject /* this */, jlong _processor, jbyteArray _table, jint _sizeX,
+        jint _sizeY, jint _sizeZ, jint _outputIndex) {
+    if (_processor == 0L) return false;
+    // Bound the sizes before multiplying them, so that the table size cannot overflow.
+    constexpr auto kMaxSize = static_cast<jint>(sample::kMaxLut3DSize);
+    RET_CHECK(0 < _sizeX && _sizeX <= kMaxSize && 0 < _sizeY && _sizeY <= kMaxSize &&
+              0 < _sizeZ && _sizeZ <= kMaxSize);
+    const size_t tableSize = static_cast<size_t>(_sizeX) * static_cast<size_t>(_sizeY) *
+                             static_cast<size_t>(_sizeZ) * 4;
+    RET_CHECK(static_cast<size_t>(env->GetArrayLength(_table)) == tableSize);
+    jbyte* table = env->GetByteArrayElements(_table, nullptr);
+    RET_CHECK(table != nullptr);
+    const bool success = castToImageProcessor(_processor)
+                                 ->lut3D(reinterpret_cast<const uint8_t*>(table), _sizeX, _sizeY,
+                                         _sizeZ, _outputIndex);
+    env->ReleaseByteArrayElements(_table, table, JNI_ABORT);
+    return success;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_executeCommandList(JNIEnv* env,
+                                                                             jobject /* this */,
+                                                                             jlong _processor,
+                                                                             jobject _commands,
+                                                                             jint _commandsSize,
+                                                                             jobject _results) {
+    if (_processor == 0L) return -1;
+    const auto* commands = static_cast<const uint8_t*>(env->GetDirectBufferAddress(_commands));
+    auto* results = static_cast<uint8_t*>(env->GetDirectBufferAddress(_results));
+    if (commands == nullptr || results == nullptr) {
+        LOGE("The command list and the results must be direct buffers");
+        return -1;
+    }
+    if (_commandsSize < 0 || _commandsSize > env->GetDirectBufferCapacity(_commands)) return -1;
+    const auto resultsSize = static_cast<size_t>(env->GetDirectBufferCapacity(_results));
+    return sample::executeCommandList(castToImageProcessor(_processor), commands,
+                                      static_cast<size_t>(_commandsSize), results, resultsSize);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_setMemoryBudget(JNIEnv* /* env */,
+                                                                          jobject /* this */,
+                                                                          jlong _processor,
+                                                                          jlong _budget) {
+    if (_processor == 0L) return false;
+    RET_CHECK(_budget >= 0);
+    return castToImageProcessor(_processor)->setMemoryBudget(static_cast<uint64_t>(_budget));
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_setResultCache(
+        JNIEnv* /* env */, jobject /* this */, jlong _processor, jlong _budget, jfloat _step) {
+    if (_processor == 0L) return false;
+    RET_CHECK(_budget >= 0);
+    return castToImageProcessor(_processor)
+            ->setResultCache(static_cast<uint64_t>(_budget), _step);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_setOutputSurface(JNIEnv* env,
+                                                                           jobject /* this */,
+                                                                           jlong _processor,
+                                                                           jobject _surface) {
+    if (_processor == 0L) return false;
+    if (_surface == nullptr) return castToImageProcessor(_processor)->setOutputWindow(nullptr);
+    ANativeWindow* window = ANativeWindow_fromSurface(env, _surface);
+    RET_CHECK(window != nullptr);
+    // The swapchain acquires its own reference to the window.
+    const bool success = castToImageProcessor(_processor)->setOutputWindow(window);
+    ANativeWindow_release(window);
+    return success;
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_getMemoryUsage(JNIEnv* /* env */,
+                                                                         jobject /* this */,
+                                                                         jlong _processor) {
+    if (_processor == 0L) return 0;
+    return static_cast<jlong>(castToImageProcessor(_processor)->getMemoryUsage());
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_waitForCompletion(JNIEnv* /* env */,
+                                                                            jobject /* this */,
+                                                                            jlong _processor) {
+    if (_processor == 0L) return false;
+    return castToImageProcessor(_processor)->waitForCompletion();
+}
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_readback(JNIEnv* /* env */,
+                                                                   jobject /* this */,
+                                                                   jlong _processor,
+                                                                   jint _outputIndex) {
+    if (_processor == 0L) return 0;
+    auto* processor = castToImageProcessor(_processor);
+    auto* readback = new Readback{processor->readback(_outputIndex), processor->imageExtent()};
+    return static_cast<jlong>(reinterpret_cast<uintptr_t>(readback));
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_VulkanImageProcessor_finishReadback(JNIEnv* env,
+                                                                         jobject /* this */,
+                                                                         jlong _readback,
+                                                                         jobject _bitmap) {
+    if (_readback == 0L) return false;
+    std::unique_ptr<Readback> readback(castToReadback(_readback));
+    const uint8_t* pixels = readback->pixels.get();
+    RET_CHECK(pixels != nullptr);
+    const VkExtent2D& extent = readback->extent;
+    return _bitmap == nullptr ||
+           copyToBitmap(env, pixels, extent.width, extent.height, /*stride=*/0, _bitmap);
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_android_example_rsmigration_VulkanImageProcessor_destroyVulkanProcessor(JNIEnv* /* env */,
                                                                                  jobject /* this */,
@@ -83,3 +376,123 @@ Java_com_android_example_rsmigration_VulkanImageProcessor_destroyVulkanProcessor
     if (_processor == 0L) return;
     delete castToImageProcessor(_processor);
 }
+
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_initCpuProcessor(
+        JNIEnv* /* env */, jobject /* this */, jint _numThreads) {
+    RET_CHECK(_numThreads >= 0);
+    auto processor = CpuImageProcessor::create(static_cast<uint32_t>(_numThreads));
+    return static_cast<jlong>(reinterpret_cast<uintptr_t>(processor.release()));
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_configureInputAndOutput(
+        JNIEnv* env, jobject /* this */, jlong _processor, jobject _inputBitmap,
+        jint _numberOfOutputImages) {
+    if (_processor == 0L) return false;
+    AndroidBitmapInfo info;
+    RET_CHECK(AndroidBitmap_getInfo(env, _inputBitmap, &info) == ANDROID_BITMAP_RESULT_SUCCESS);
+    RET_CHECK(info.format == ANDROID_BITMAP_FORMAT_RGBA_8888);
+    void* pixels = nullptr;
+    RET_CHECK(AndroidBitmap_lockPixels(env, _inputBitmap, &pixels) ==
+              ANDROID_BITMAP_RESULT_SUCCESS);
+    const sample::cpu::BitmapView input = {static_cast<uint8_t*>(pixels), info.width, info.height,
+                                           info.stride};
+    const bool success =
+            castToCpuImageProcessor(_processor)->configureInputAndOutput(input,
+                                                                         _numberOfOutputImages);
+    AndroidBitmap_unlockPixels(env, _inputBitmap);
+    return success;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_rotateHue(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radian, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radian, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->rotateHue(_radian, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_saturation(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _saturation, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_saturation, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->saturation(_saturation, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_blur(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radius, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radius, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->blur(_radius, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_recursiveBlur(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radius, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radius, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->recursiveBlur(_radius, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_boxBlur(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radius, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radius, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->boxBlur(_radius, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_stackedBoxBlur(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radius, jint _outputIndex,
+        jobject _outputBitmap) {
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radius, _outputIndex](CpuImageProcessor* processor) {
+                            return processor->stackedBoxBlur(_radius, _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_adjustColors(
+        JNIEnv* env, jobject /* this */, jlong _processor, jfloat _radian, jfloat _saturation,
+        jbyteArray _red, jbyteArray _green, jbyteArray _blue, jbyteArray _alpha, jint _outputIndex,
+        jobject _outputBitmap) {
+    std::array<std::array<jbyte, sample::kNumHistogramBins>, 4> tables;
+    const jbyteArray arrays[] = {_red, _green, _blue, _alpha};
+    for (size_t i = 0; i < tables.size(); i++) {
+        RET_CHECK(env->GetArrayLength(arrays[i]) == static_cast<jsize>(sample::kNumHistogramBins));
+        env->GetByteArrayRegion(arrays[i], 0, sample::kNumHistogramBins, tables[i].data());
+    }
+    return runCpuFilter(env, _processor, _outputIndex, _outputBitmap,
+                        [_radian, _saturation, &tables,
+                         _outputIndex](CpuImageProcessor* processor) {
+                            return processor->adjustColors(
+                                    _radian, _saturation,
+                                    reinterpret_cast<const uint8_t*>(tables[0].data()),
+                                    reinterpret_cast<const uint8_t*>(tables[1].data()),
+                                    reinterpret_cast<const uint8_t*>(tables[2].data()),
+                                    reinterpret_cast<const uint8_t*>(tables[3].data()),
+                                    _outputIndex);
+                        });
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_android_example_rsmigration_CpuImageProcessor_destroyCpuProcessor(JNIEnv* /* env */,
+                                                                           jobject /* this */,
+                                                                           jlong _processor) {
+    if (_processor == 0L) return;
+    delete castToCpuImageProcessor(_processor);
+}
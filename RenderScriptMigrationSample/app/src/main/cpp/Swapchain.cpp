@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Swapchain.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+namespace sample {
+namespace {
+
+// Choose the swapchain format. The blit converts the RGBA source to any format that supports
+// being a blit destination, prefer RGBA to avoid the swizzle.
+std::optional<VkSurfaceFormatKHR> chooseSurfaceFormat(
+        VkPhysicalDevice physicalDevice, const std::vector<VkSurfaceFormatKHR>& formats) {
+    std::vector<VkSurfaceFormatKHR> candidates;
+    for (const auto& format : formats) {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format.format, &properties);
+        if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT) {
+            candidates.push_back(format);
+        }
+    }
+    if (candidates.empty()) return std::nullopt;
+    const auto it = std::find_if(candidates.begin(), candidates.end(), [](const auto& format) {
+        return format.format == VK_FORMAT_R8G8B8A8_UNORM;
+    });
+    return it != candidates.end() ? *it : candidates.front();
+}
+
+}  // namespace
+
+std::unique_ptr<Swapchain> Swapchain::create(const VulkanContext* context, ANativeWindow* window) {
+    if (!context->supportsPresentation()) {
+        LOGE("Swapchain::create: Presentation is not supported by the device");
+        return nullptr;
+    }
+    auto swapchain = std::make_unique<Swapchain>(context, window);
+    const bool success = swapchain->createSurface() && swapchain->createSwapchain();
+    return success ? std::move(swapchain) : nullptr;
+}
+
+Swapchain::~Swapchain() {
+    if (mSwapchain.handle() != VK_NULL_HANDLE) mContext->waitQueueIdle();
+}
+
+bool Swapchain::createSurface() {
+    const VkAndroidSurfaceCreateInfoKHR surfaceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .flags = 0,
+            .window = mWindow.get(),
+    };
+    CALL_VK(vkCreateAndroidSurfaceKHR, mContext->instance(), &surfaceCreateInfo, nullptr,
+            mSurface.pHandle());
+
+    // The filters run on the compute queue, which must also be able to present.
+    VkBool32 supported = VK_FALSE;
+    CALL_VK(vkGetPhysicalDeviceSurfaceSupportKHR, mContext->physicalDevice(),
+            mContext->queueFamilyIndex(), mSurface.handle(), &supported);
+    RET_CHECK(supported == VK_TRUE);
+    return true;
+}
+
+bool Swapchain::createSwapchain() {
+    const VkPhysicalDevice physicalDevice = mContext->physicalDevice();
+    VkSurfaceCapabilitiesKHR capabilities;
+    CALL_VK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, physicalDevice, mSurface.handle(),
+            &capabilities);
+    RET_CHECK(capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+    uint32_t numFormats = 0;
+    CALL_VK(vkGetPhysicalDeviceSurfaceFormatsKHR, physicalDevice, mSurface.handle(), &numFormats,
+            nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(numFormats);
+    CALL_VK(vkGetPhysicalDeviceSurfaceFormatsKHR, physicalDevice, mSurface.handle(), &numFormats,
+            formats.data());
+    const auto surfaceFormat = chooseSurfaceFormat(physicalDevice, formats);
+    RET_CHECK(surfaceFormat.has_value());
+    mFormat = surfaceFormat->format;
+
+    // The extent is undefined if the window has no buffers yet, use the window size then.
+    if (capabilities.currentExtent.width == UINT32_MAX) {
+        mExtent = {static_cast<uint32_t>(ANativeWindow_getWidth(mWindow.get())),
+                   static_cast<uint32_t>(ANativeWindow_getHeight(mWindow.get()))};
+    } else {
+        mExtent = capabilities.currentExtent;
+    }
+    RET_CHECK(mExtent.width > 0 && mExtent.height > 0);
+
+    // One more image than the minimum, so that the next frame does not wait for the display.
+    uint32_t numImages = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0) numImages = std::min(numImages, capabilities.maxImageCount);
+
+    // Leave the rotation of the display to the compositor.
+    const auto preTransform =
+            (capabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR)
+                    ? VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR
+                    : capabilities.currentTransform;
+    const auto compositeAlpha =
+            (capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR)
+                    ? VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR
+                    : VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+
+    const VkSwapchainCreateInfoKHR swapchainCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .flags = 0,
+            .surface = mSurface.handle(),
+            .minImageCount = numImages,
+            .imageFormat = surfaceFormat->format,
+            .imageColorSpace = surfaceFormat->colorSpace,
+            .imageExtent = mExtent,
+            .imageArrayLayers = 1,
+            .imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+            .preTransform = preTransform,
+            .compositeAlpha = compositeAlpha,
+            .presentMode = VK_PRESENT_MODE_FIFO_KHR,
+            .clipped = VK_TRUE,
+            .oldSwapchain = mSwapchain.handle(),
+    };
+    VulkanSwapchainKHR swapchain(mContext->device());
+    CALL_VK(vkCreateSwapchainKHR, mContext->device(), &swapchainCreateInfo, nullptr,
+            swapchain.pHandle());
+
+    // The previous swapchain, if any, is destroyed at the end of the scope. Its images may still be
+    // blitted to or queued for presentation, which the timeline does not cover, so wait for the
+    // queue to be idle first. The swapchain is only recreated on resizes, so the stall is rare.
+    if (mSwapchain.handle() != VK_NULL_HANDLE) RET_CHECK(mContext->waitQueueIdle());
+    std::swap(mSwapchain, swapchain);
+    uint32_t numSwapchainImages = 0;
+    CALL_VK(vkGetSwapchainImagesKHR, mContext->device(), mSwapchain.handle(), &numSwapchainImages,
+            nullptr);
+    mImages.resize(numSwapchainImages);
+    CALL_VK(vkGetSwapchainImagesKHR, mContext->device(), mSwapchain.handle(), &numSwapchainImages,
+            mImages.data());
+    mAcquireSemaphoreOfImage.resize(numSwapchainImages);
+
+    // The semaphores are only added, as the previous swapchain may still be presenting with them.
+    while (mAcquireSemaphores.size() < numSwapchainImages) {
+        mAcquireSemaphores.emplace_back(mContext->device());
+        RET_CHECK(mContext->createSemaphore(mAcquireSemaphores.back().pHandle()));
+    }
+    while (mPresentSemaphores.size() < numSwapchainImages) {
+        mPresentSemaphores.emplace_back(mContext->device());
+        RET_CHECK(mContext->createSemaphore(mPresentSemaphores.back().pHandle()));
+    }
+    mOutOfDate = false;
+    LOGV("Swapchain: %u images of %ux%u, format = %d", numSwapchainImages, mExtent.width,
+         mExtent.height, mFormat);
+    return true;
+}
+
+bool Swapchain::acquireNextImage(uint32_t* imageIndex) {
+    if (mOutOfDate) RET_CHECK(createSwapchain());
+    const uint32_t semaphoreIndex = mNextAcquireSemaphore;
+    const VkSemaphore semaphore = mAcquireSemaphores[semaphoreIndex].handle();
+    VkResult result = vkAcquireNextImageKHR(mContext->device(), mSwapchain.handle(), UINT64_MAX,
+                                            semaphore, VK_NULL_HANDLE, imageIndex);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        RET_CHECK(createSwapchain());
+        result = vkAcquireNextImageKHR(mContext->device(), mSwapchain.handle(), UINT64_MAX,
+                                       semaphore, VK_NULL_HANDLE, imageIndex);
+    }
+
+    // A suboptimal image can still be presented, the swapchain is recreated for the next frame.
+    if (result == VK_SUBOPTIMAL_KHR) {
+        mOutOfDate = true;
+    } else if (result != VK_SUCCESS) {
+        LOGE("vkAcquireNextImageKHR failed with %s", vkResultToStr(result));
+        return false;
+    }
+    mAcquireSemaphoreOfImage[*imageIndex] = semaphoreIndex;
+    mNextAcquireSemaphore =
+            (semaphoreIndex + 1) % static_cast<uint32_t>(mAcquireSemaphores.size());
+    return true;
+}
+
+void Swapchain::recordBlit(VkCommandBuffer cmd, const Image& sourceImage,
+                           uint32_t imageIndex) const {
+    // The whole image is overwritten, so the previous content is discarded. The barrier waits for
+    // the acquisition, which the submission waits for at the transfer stage.
+    VkImageMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = mImages[imageIndex],
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+
+    // Scale the source image to the window size.
+    const VkImageBlit imageBlit = {
+            .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .srcOffsets = {{0, 0, 0},
+                           {static_cast<int32_t>(sourceImage.width()),
+                            static_cast<int32_t>(sourceImage.height()), 1}},
+            .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .dstOffsets = {{0, 0, 0},
+                           {static_cast<int32_t>(mExtent.width),
+                            static_cast<int32_t>(mExtent.height), 1}},
+    };
+    vkCmdBlitImage(cmd, sourceImage.getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   mImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit,
+                   VK_FILTER_LINEAR);
+
+    // Prepare for the presentation, which is ordered by the present semaphore.
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+VulkanContext::SubmitSemaphores Swapchain::getSubmitSemaphores(uint32_t imageIndex) const {
+    return {
+            .wait = mAcquireSemaphores[mAcquireSemaphoreOfImage[imageIndex]].handle(),
+            .waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .signal = mPresentSemaphores[imageIndex].handle(),
+    };
+}
+
+bool Swapchain::present(uint32_t imageIndex) {
+    const VkResult result = mContext->present(mSwapchain.handle(), imageIndex,
+                                              mPresentSemaphores[imageIndex].handle());
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+        // The image is consumed, the swapchain is recreated before the next acquisition.
+        mOutOfDate = true;
+        return true;
+    }
+    if (result != VK_SUCCESS) {
+        LOGE("vkQueuePresentKHR failed with %s", vkResultToStr(result));
+        return false;
+    }
+    return true;
+}
+
+}  // namespace sample
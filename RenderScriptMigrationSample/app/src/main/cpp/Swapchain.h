@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_SWAPCHAIN_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_SWAPCHAIN_H
+
+#include <android/native_window.h>
+
+#include <memory>
+#include <vector>
+
+#include "Utils.h"
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+// Swapchain presents images to an ANativeWindow, e.g. the Surface of a SurfaceView. The filter
+// results are blitted into the acquired swapchain image, scaled to the window size, and presented
+// on the compute queue with the FIFO present mode.
+//
+// A frame is acquired with Swapchain::acquireNextImage, recorded with Swapchain::recordBlit,
+// submitted with the semaphores of Swapchain::getSubmitSemaphores, and queued with
+// Swapchain::present. The swapchain is recreated when it no longer matches the window, e.g. after
+// a resize.
+class Swapchain {
+   public:
+    // Create a swapchain for the window. The swapchain keeps a reference to the window.
+    // Return nullptr if failed, e.g. if the context does not support presentation.
+    static std::unique_ptr<Swapchain> create(const VulkanContext* context, ANativeWindow* window);
+
+    // Prefer Swapchain::create
+    Swapchain(const VulkanContext* context, ANativeWindow* window)
+        : mContext(context),
+          mWindow(window, ANativeWindow_release),
+          mSurface(context->instance()),
+          mSwapchain(context->device()) {
+        ANativeWindow_acquire(window);
+    }
+
+    // Wait for the queue to be idle before the swapchain and its semaphores are destroyed, as the
+    // queued presentations are not covered by the timeline.
+    ~Swapchain();
+
+    // Acquire the next swapchain image, blocking until one is available. The acquisition completes
+    // on the device when the wait semaphore of Swapchain::getSubmitSemaphores is signaled.
+    bool acquireNextImage(uint32_t* imageIndex);
+
+    // Record a blit of the source image, which must be in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    // to the acquired image, and the transition of the acquired image for presentation.
+    void recordBlit(VkCommandBuffer cmd, const Image& sourceImage, uint32_t imageIndex) const;
+
+    // The semaphores of the submission of the commands recorded for the acquired image.
+    VulkanContext::SubmitSemaphores getSubmitSemaphores(uint32_t imageIndex) const;
+
+    // Queue the presentation of the acquired image after the submission.
+    bool present(uint32_t imageIndex);
+
+   private:
+    // Initialization
+    bool createSurface();
+    bool createSwapchain();
+
+    const VulkanContext* mContext;
+
+    // The window is released after the surface and the swapchain are destroyed.
+    std::unique_ptr<ANativeWindow, decltype(&ANativeWindow_release)> mWindow;
+
+    VkFormat mFormat = VK_FORMAT_UNDEFINED;
+    VkExtent2D mExtent = {0, 0};
+
+    // Whether the swapchain must be recreated before the next acquisition.
+    bool mOutOfDate = false;
+
+    // Managed handles. The swapchain is declared after the surface, so that it is destroyed first.
+    VulkanSurfaceKHR mSurface;
+    VulkanSwapchainKHR mSwapchain;
+    std::vector<VkImage> mImages;
+
+    // The acquire semaphores are used in turn, as the next image may be acquired before the
+    // previous acquisition has completed. The present semaphores are indexed by the image.
+    std::vector<VulkanSemaphore> mAcquireSemaphores;
+    std::vector<VulkanSemaphore> mPresentSemaphores;
+    uint32_t mNextAcquireSemaphore = 0;
+    std::vector<uint32_t> mAcquireSemaphoreOfImage;
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_SWAPCHAIN_H
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TransientAllocator.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "Utils.h"
+
+namespace sample {
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+uint32_t TransientAllocator::declareImage(uint32_t width, uint32_t height, VkImageUsageFlags usage,
+                                          VkFormat format) {
+    mImages.push_back({width, height, usage, format, {}, nullptr});
+    return static_cast<uint32_t>(mImages.size() - 1);
+}
+
+void TransientAllocator::beginChain() { mChainBase = mNextChainBase; }
+
+void TransientAllocator::declareUse(uint32_t image, uint32_t firstStep, uint32_t lastStep) {
+    mImages[image].uses.push_back({mChainBase + firstStep, mChainBase + lastStep});
+    mNextChainBase = std::max(mNextChainBase, mChainBase + lastStep + 1);
+}
+
+bool TransientAllocator::overlaps(const TransientImage& a, const TransientImage& b) {
+    for (const auto& x : a.uses) {
+        for (const auto& y : b.uses) {
+            if (x.first <= y.last && y.first <= x.last) return true;
+        }
+    }
+    return false;
+}
+
+bool TransientAllocator::allocate() {
+    if (isAllocated()) return true;
+    RET_CHECK(!mImages.empty());
+
+    // Create the images without memory, and collect their memory requirements.
+    std::vector<VkMemoryRequirements> requirements(mImages.size());
+    uint32_t memoryTypeBits = ~0u;
+    for (size_t i = 0; i < mImages.size(); i++) {
+        auto& transient = mImages[i];
+        transient.image = Image::createUnbound(mContext, transient.width, transient.height,
+                                               transient.usage, transient.format);
+        RET_CHECK(transient.image != nullptr);
+        requirements[i] = transient.image->getMemoryRequirements();
+        memoryTypeBits &= requirements[i].memoryTypeBits;
+    }
+
+    // Place the images from the largest to the smallest, each at the lowest offset where it does
+    // not overlap the memory of a placed image in use at the same step. The candidate offsets are
+    // the start of the memory and the ends of the conflicting images.
+    std::vector<size_t> order(mImages.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&requirements](size_t a, size_t b) {
+        return requirements[a].size > requirements[b].size;
+    });
+    std::vector<size_t> placed;
+    VkDeviceSize totalSize = 0;
+    for (const size_t i : order) {
+        std::vector<size_t> conflicts;
+        std::copy_if(placed.begin(), placed.end(), std::back_inserter(conflicts),
+                     [this, i](size_t j) { return overlaps(mImages[i], mImages[j]); });
+        std::vector<VkDeviceSize> candidates = {0};
+        for (const size_t j : conflicts) {
+            candidates.push_back(mImages[j].offset + requirements[j].size);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        const VkDeviceSize size = requirements[i].size;
+        for (const VkDeviceSize candidate : candidates) {
+            const VkDeviceSize offset = alignUp(candidate, requirements[i].alignment);
+            const bool isFree =
+                    std::none_of(conflicts.begin(), conflicts.end(), [&](size_t j) {
+                        return offset < mImages[j].offset + requirements[j].size &&
+                               mImages[j].offset < offset + size;
+                    });
+            if (isFree) {
+                mImages[i].offset = offset;
+                break;
+            }
+        }
+        placed.push_back(i);
+        totalSize = std::max(totalSize, mImages[i].offset + size);
+    }
+
+    // Allocate the shared memory and bind the images.
+    const auto memoryTypeIndex =
+            mContext->findMemoryType(memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    RET_CHECK(memoryTypeIndex.has_value());
+    const VkMemoryAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .allocationSize = totalSize,
+            .memoryTypeIndex = memoryTypeIndex.value(),
+    };
+    auto memory = std::make_unique<DeviceMemory>(mContext);
+    RET_CHECK(memory->allocate(allocateInfo));
+    for (auto& transient : mImages) {
+        RET_CHECK(transient.image->bindMemory(memory->handle(), transient.offset));
+    }
+    mMemory = std::move(memory);
+
+    VkDeviceSize unaliasedSize = 0;
+    for (const auto& r : requirements) unaliasedSize += r.size;
+    LOGV("Transient images: %zu images, %zu bytes aliased into %zu bytes", mImages.size(),
+         static_cast<size_t>(unaliasedSize), static_cast<size_t>(totalSize));
+    return true;
+}
+
+void TransientAllocator::release() {
+    for (auto& transient : mImages) transient.image = nullptr;
+    mMemory = nullptr;
+}
+
+void TransientAllocator::discardContent() {
+    for (auto& transient : mImages) {
+        if (transient.image != nullptr) transient.image->discardContent();
+    }
+}
+
+}  // namespace sample
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_TRANSIENT_ALLOCATOR_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_TRANSIENT_ALLOCATOR_H
+
+#include <vulkan/vulkan_core.h>
+
+#include <memory>
+#include <vector>
+
+#include "VulkanContext.h"
+#include "VulkanResources.h"
+
+namespace sample {
+
+// TransientAllocator places the images used only within a recorded command chain in a single
+// device memory allocation, aliasing the memory of images whose lifetimes do not overlap.
+//
+// The lifetimes are declared in steps: a chain is a sequence of steps recorded into one command
+// buffer, and an image is in use from the step writing it first to the step reading it last.
+// Images used in different chains never overlap, as the chains are never recorded together.
+// The content of the images is undefined at the start of each chain, see discardContent.
+class TransientAllocator {
+   public:
+    explicit TransientAllocator(const VulkanContext* context) : mContext(context) {}
+
+    // Declare an image, and return its index to TransientAllocator::getImage.
+    uint32_t declareImage(uint32_t width, uint32_t height, VkImageUsageFlags usage,
+                          VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
+    // Start a new chain. The steps of the following declareUse calls are counted from the start
+    // of the chain.
+    void beginChain();
+
+    // Declare that the image is in use from firstStep to lastStep, inclusive, of the current chain.
+    void declareUse(uint32_t image, uint32_t firstStep, uint32_t lastStep);
+
+    // Create the declared images and bind them to a shared device local memory allocation.
+    bool allocate();
+
+    // Release the images and the memory. The declarations are kept, so that
+    // TransientAllocator::allocate can be called again.
+    void release();
+
+    bool isAllocated() const { return mMemory != nullptr; }
+
+    // Return the indexed image, or nullptr if not allocated.
+    Image* getImage(uint32_t index) const {
+        return isAllocated() ? mImages[index].image.get() : nullptr;
+    }
+
+    // Return the size in bytes of the shared memory, or 0 if not allocated.
+    VkDeviceSize memorySize() const { return isAllocated() ? mMemory->size() : 0; }
+
+    // Mark the content of all images as undefined. Must be called before recording each chain,
+    // so that the first use of an image waits for the previous users of the aliased memory.
+    void discardContent();
+
+   private:
+    struct Interval {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    struct TransientImage {
+        uint32_t width;
+        uint32_t height;
+        VkImageUsageFlags usage;
+        VkFormat format;
+        std::vector<Interval> uses;
+        std::unique_ptr<Image> image;
+        VkDeviceSize offset = 0;
+    };
+
+    // Return true if the two images are in use at the same step.
+    static bool overlaps(const TransientImage& a, const TransientImage& b);
+
+    const VulkanContext* mContext;
+
+    // The shared memory is declared before the images, so that the images are destroyed first.
+    std::unique_ptr<DeviceMemory> mMemory;
+    std::vector<TransientImage> mImages;
+
+    // The step of the current chain start, and the first step after all declared uses.
+    uint32_t mChainBase = 0;
+    uint32_t mNextChainBase = 0;
+};
+
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_TRANSIENT_ALLOCATOR_H
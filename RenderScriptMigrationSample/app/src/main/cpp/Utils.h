@@ -188,6 +188,18 @@ class VulkanObjectFromInstance : public VulkanObjectBase<T_VkHandle> {
     VkInstance mInstance = VK_NULL_HANDLE;
 };
 
+#define VULKAN_RAII_OBJECT_FROM_INSTANCE(Type, destroyer)           \
+    struct Vulkan##Type##Destroyer {                                \
+        static void destroy(VkInstance instance, Vk##Type handle) { \
+            destroyer(instance, handle, nullptr);                   \
+        }                                                           \
+    };                                                              \
+    using Vulkan##Type = VulkanObjectFromInstance<Vk##Type, Vulkan##Type##Destroyer>;
+
+VULKAN_RAII_OBJECT_FROM_INSTANCE(SurfaceKHR, vkDestroySurfaceKHR);
+
+#undef VULKAN_RAII_OBJECT_FROM_INSTANCE
+
 // Vulkan objects that is created/allocated with a device
 template <typename T_VkHandle, typename T_Destroyer>
 class VulkanObjectFromDevice : public VulkanObjectBase<T_VkHandle> {
@@ -229,6 +241,8 @@ VULKAN_RAII_OBJECT_FROM_DEVICE(Image, vkDestroyImage);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Sampler, vkDestroySampler);
 VULKAN_RAII_OBJECT_FROM_DEVICE(ImageView, vkDestroyImageView);
 VULKAN_RAII_OBJECT_FROM_DEVICE(Semaphore, vkDestroySemaphore);
+VULKAN_RAII_OBJECT_FROM_DEVICE(Fence, vkDestroyFence);
+VULKAN_RAII_OBJECT_FROM_DEVICE(SwapchainKHR, vkDestroySwapchainKHR);
 
 #undef VULKAN_RAII_OBJECT_FROM_DEVICE
 
@@ -18,15 +18,20 @@
 
 #include <android/hardware_buffer_jni.h>
 #include <android/log.h>
+#include <pthread.h>
 #include <vulkan/vulkan_android.h>
 #include <vulkan/vulkan_core.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "Utils.h"
@@ -58,16 +63,93 @@ uint32_t chooseWorkGroupSize(const VkPhysicalDeviceLimits& limits) {
     return size;
 }
 
+bool hasInstanceExtension(const char* extension) {
+    uint32_t numExtensions = 0;
+    CALL_VK(vkEnumerateInstanceExtensionProperties, nullptr, &numExtensions, nullptr);
+    std::vector<VkExtensionProperties> extensions(numExtensions);
+    CALL_VK(vkEnumerateInstanceExtensionProperties, nullptr, &numExtensions, extensions.data());
+    return std::any_of(extensions.begin(), extensions.end(), [extension](const auto& properties) {
+        return std::strcmp(properties.extensionName, extension) == 0;
+    });
+}
+
+bool hasDeviceExtension(VkPhysicalDevice device, const char* extension) {
+    uint32_t numExtensions = 0;
+    CALL_VK(vkEnumerateDeviceExtensionProperties, device, nullptr, &numExtensions, nullptr);
+    std::vector<VkExtensionProperties> extensions(numExtensions);
+    CALL_VK(vkEnumerateDeviceExtensionProperties, device, nullptr, &numExtensions,
+            extensions.data());
+    return std::any_of(extensions.begin(), extensions.end(), [extension](const auto& properties) {
+        return std::strcmp(properties.extensionName, extension) == 0;
+    });
+}
+
+// Release the command pools of the exiting thread from the contexts still alive. Called by the
+// thread-specific data key of releaseOnThreadExit with the weak references to the pools.
+void releaseThreadCommandPools(void* data) {
+    auto* references = static_cast<std::vector<std::weak_ptr<ThreadCommandPools>>*>(data);
+    const auto id = std::this_thread::get_id();
+    for (const auto& reference : *references) {
+        const std::shared_ptr<ThreadCommandPools> threadPools = reference.lock();
+        if (threadPools == nullptr) continue;
+        std::lock_guard<std::mutex> lock(threadPools->mutex);
+        threadPools->pools.erase(id);
+    }
+    delete references;
+}
+
+// Release the pool of the calling thread in threadPools when the thread exits, so that the pools
+// do not accumulate with the threads, and a thread recycling the id does not inherit a pool.
+void releaseOnThreadExit(const std::shared_ptr<ThreadCommandPools>& threadPools) {
+    // A thread_local object would need an exit-time destructor. The key is intentionally leaked.
+    static const pthread_key_t key = [] {
+        pthread_key_t newKey;
+        pthread_key_create(&newKey, releaseThreadCommandPools);
+        return newKey;
+    }();
+    auto* references =
+            static_cast<std::vector<std::weak_ptr<ThreadCommandPools>>*>(pthread_getspecific(key));
+    if (references == nullptr) {
+        references = new std::vector<std::weak_ptr<ThreadCommandPools>>();
+        pthread_setspecific(key, references);
+    }
+    // Drop the references to the destroyed contexts.
+    references->erase(std::remove_if(references->begin(), references->end(),
+                                     [](const auto& reference) { return reference.expired(); }),
+                      references->end());
+    references->push_back(threadPools);
+}
+
 }  // namespace
 
+VulkanContext::~VulkanContext() {
+    // The exiting threads may still hold a reference to the pools, so destroy the pools before
+    // the device rather than with the last reference.
+    std::lock_guard<std::mutex> lock(mThreadCommandPools->mutex);
+    mThreadCommandPools->pools.clear();
+}
+
 std::unique_ptr<VulkanContext> VulkanContext::create(bool enableDebug) {
     auto vk = std::make_unique<VulkanContext>();
     const bool success = vk->checkInstanceVersion() && vk->createInstance(enableDebug) &&
                          vk->pickPhysicalDeviceAndQueueFamily() && vk->createDevice() &&
-                         vk->createPools();
+                         vk->createTimelineSemaphore();
     return success ? std::move(vk) : nullptr;
 }
 
+std::shared_ptr<VulkanContext> VulkanContext::getShared(bool enableDebug) {
+    // Intentionally leaked to avoid the exit-time destructors.
+    static auto* mutex = new std::mutex();
+    static auto* sharedContext = new std::weak_ptr<VulkanContext>();
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::shared_ptr<VulkanContext> context = sharedContext->lock();
+    if (context == nullptr) {
+        context = create(enableDebug);
+        *sharedContext = context;
+    }
+    return context;
+}
+
 bool VulkanContext::checkInstanceVersion() {
     CALL_VK(vkEnumerateInstanceVersion, &mInstanceVersion);
     if (VK_VERSION_MAJOR(mInstanceVersion) != 1) {
@@ -95,6 +177,15 @@ bool VulkanContext::createInstance(bool enableDebug) {
         instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    // Enable the surface extensions if available, which are only needed for the presentation to
+    // an ANativeWindow.
+    mSurfaceEnabled = hasInstanceExtension(VK_KHR_SURFACE_EXTENSION_NAME) &&
+                      hasInstanceExtension(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
+    if (mSurfaceEnabled) {
+        instanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        instanceExtensions.push_back(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
+    }
+
     // Create instance
     const VkApplicationInfo applicationDesc = {
             .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
@@ -146,6 +237,26 @@ bool VulkanContext::pickPhysicalDeviceAndQueueFamily() {
     RET_CHECK(mPhysicalDevice != VK_NULL_HANDLE);
     vkGetPhysicalDeviceProperties(mPhysicalDevice, &mPhysicalDeviceProperties);
     mWorkGroupSize = chooseWorkGroupSize(mPhysicalDeviceProperties.limits);
+
+    // Query the subgroup operations supported in compute shaders, which requires Vulkan 1.1 on
+    // both the instance and the device.
+    if (VK_VERSION_MINOR(mInstanceVersion) >= 1 &&
+        VK_VERSION_MINOR(mPhysicalDeviceProperties.apiVersion) >= 1) {
+        VkPhysicalDeviceSubgroupProperties subgroupProperties = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES,
+                .pNext = nullptr,
+        };
+        VkPhysicalDeviceProperties2 properties2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &subgroupProperties,
+        };
+        vkGetPhysicalDeviceProperties2(mPhysicalDevice, &properties2);
+        if (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) {
+            mSubgroupOperations = subgroupProperties.supportedOperations;
+        }
+        LOGV("Subgroup size: %d, supported operations: 0x%x", subgroupProperties.subgroupSize,
+             mSubgroupOperations);
+    }
     vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &mPhysicalDeviceMemoryProperties);
     LOGV("Using physical device '%s'", mPhysicalDeviceProperties.deviceName);
     return true;
@@ -162,6 +273,44 @@ bool VulkanContext::createDevice() {
             VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME,
     };
 
+    // Enable timeline semaphores if available. Querying the feature requires Vulkan 1.1.
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+            .pNext = nullptr,
+            .timelineSemaphore = VK_FALSE,
+    };
+    if (VK_VERSION_MINOR(mInstanceVersion) >= 1 &&
+        VK_VERSION_MINOR(mPhysicalDeviceProperties.apiVersion) >= 1 &&
+        hasDeviceExtension(mPhysicalDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        VkPhysicalDeviceFeatures2 features2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &timelineSemaphoreFeatures,
+        };
+        vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &features2);
+    }
+    mTimelineSemaphoreEnabled = timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+    if (mTimelineSemaphoreEnabled) {
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
+    LOGV("Timeline semaphore supported: %d", mTimelineSemaphoreEnabled);
+
+    // Enable the memory budget query if available, which also requires Vulkan 1.1.
+    mMemoryBudgetEnabled = VK_VERSION_MINOR(mInstanceVersion) >= 1 &&
+                           VK_VERSION_MINOR(mPhysicalDeviceProperties.apiVersion) >= 1 &&
+                           hasDeviceExtension(mPhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (mMemoryBudgetEnabled) {
+        deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    LOGV("Memory budget supported: %d", mMemoryBudgetEnabled);
+
+    // Enable swapchains if the instance supports surfaces.
+    mPresentationEnabled =
+            mSurfaceEnabled && hasDeviceExtension(mPhysicalDevice, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (mPresentationEnabled) {
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+    LOGV("Presentation supported: %d", mPresentationEnabled);
+
     // Create logical device
     const float queuePriority = 1.0f;
     const VkDeviceQueueCreateInfo queueDesc = {
@@ -172,6 +321,7 @@ bool VulkanContext::createDevice() {
     };
     const VkDeviceCreateInfo deviceDesc = {
             .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+            .pNext = mTimelineSemaphoreEnabled ? &timelineSemaphoreFeatures : nullptr,
             .queueCreateInfoCount = 1,
             .pQueueCreateInfos = &queueDesc,
             .enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
@@ -183,43 +333,52 @@ bool VulkanContext::createDevice() {
     return true;
 }
 
-bool VulkanContext::createPools() {
-    // Create descriptor pool
-    mDescriptorPool = VulkanDescriptorPool(mDevice.handle());
-    const std::vector<VkDescriptorPoolSize> descriptorPoolSizes = {
-            {
-                    .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                    // We have three pipelines, each need 1 combined image sampler descriptor.
-                    .descriptorCount = 3,
-            },
-            {
-                    .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                    // We have three pipelines, each need 1 storage image descriptor.
-                    .descriptorCount = 3,
-            },
-            {
-                    .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    // We have three pipelines, each need 1 uniform buffer.
-                    .descriptorCount = 3,
-            },
+bool VulkanContext::createTimelineSemaphore() {
+    if (!mTimelineSemaphoreEnabled) return true;
+    mWaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(
+            vkGetDeviceProcAddr(mDevice.handle(), "vkWaitSemaphoresKHR"));
+    RET_CHECK(mWaitSemaphores != nullptr);
+
+    const VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = nullptr,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = 0,
     };
-    const VkDescriptorPoolCreateInfo descriptorPoolDesc = {
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets = 3,
-            .poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size()),
-            .pPoolSizes = descriptorPoolSizes.data(),
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &semaphoreTypeCreateInfo,
+            .flags = 0,
     };
-    CALL_VK(vkCreateDescriptorPool, mDevice.handle(), &descriptorPoolDesc, nullptr,
-            mDescriptorPool.pHandle());
+    mTimelineSemaphore = VulkanSemaphore(mDevice.handle());
+    CALL_VK(vkCreateSemaphore, mDevice.handle(), &semaphoreCreateInfo, nullptr,
+            mTimelineSemaphore.pHandle());
+    return true;
+}
+
+VkCommandPool VulkanContext::commandPool() const {
+    std::lock_guard<std::mutex> lock(mThreadCommandPools->mutex);
+    auto& pools = mThreadCommandPools->pools;
+    const auto id = std::this_thread::get_id();
+    auto it = pools.find(id);
+    if (it == pools.end()) {
+        VulkanCommandPool pool(mDevice.handle());
+        if (!createCommandPool(&pool)) return VK_NULL_HANDLE;
+        it = pools.emplace(id, std::move(pool)).first;
+        releaseOnThreadExit(mThreadCommandPools);
+    }
+    return it->second.handle();
+}
 
-    // Create command pool
-    mCommandPool = VulkanCommandPool(mDevice.handle());
+bool VulkanContext::createCommandPool(VulkanCommandPool* commandPool) const {
+    if (commandPool == nullptr) return false;
+    *commandPool = VulkanCommandPool(mDevice.handle());
     const VkCommandPoolCreateInfo cmdpoolDesc = {
             .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
             .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
             .queueFamilyIndex = mQueueFamilyIndex,
     };
-    CALL_VK(vkCreateCommandPool, mDevice.handle(), &cmdpoolDesc, nullptr, mCommandPool.pHandle());
+    CALL_VK(vkCreateCommandPool, mDevice.handle(), &cmdpoolDesc, nullptr, commandPool->pHandle());
     return true;
 }
 
@@ -237,6 +396,49 @@ std::optional<uint32_t> VulkanContext::findMemoryType(uint32_t memoryTypeBits,
     return std::nullopt;
 }
 
+void VulkanContext::onMemoryAllocated(uint32_t memoryTypeIndex, VkDeviceSize size) const {
+    const uint32_t heapIndex =
+            mPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    std::lock_guard<std::mutex> lock(mMemoryMutex);
+    mHeapUsage[heapIndex] += size;
+}
+
+void VulkanContext::onMemoryFreed(uint32_t memoryTypeIndex, VkDeviceSize size) const {
+    const uint32_t heapIndex =
+            mPhysicalDeviceMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    std::lock_guard<std::mutex> lock(mMemoryMutex);
+    mHeapUsage[heapIndex] -= size;
+}
+
+VulkanContext::MemoryBudget VulkanContext::getDeviceLocalMemoryBudget() const {
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+            .pNext = nullptr,
+    };
+    if (mMemoryBudgetEnabled) {
+        VkPhysicalDeviceMemoryProperties2 properties2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+                .pNext = &budgetProperties,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &properties2);
+    }
+
+    MemoryBudget result;
+    std::lock_guard<std::mutex> lock(mMemoryMutex);
+    for (uint32_t i = 0; i < mPhysicalDeviceMemoryProperties.memoryHeapCount; i++) {
+        const auto& heap = mPhysicalDeviceMemoryProperties.memoryHeaps[i];
+        if (!(heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+        if (mMemoryBudgetEnabled) {
+            result.budget += budgetProperties.heapBudget[i];
+            result.usage += budgetProperties.heapUsage[i];
+        } else {
+            result.budget += heap.size;
+            result.usage += mHeapUsage[i];
+        }
+    }
+    return result;
+}
+
 bool VulkanContext::createSemaphore(VkSemaphore* semaphore) const {
     if (semaphore == nullptr) return false;
     const VkSemaphoreCreateInfo semaphoreCreateInfo = {
@@ -248,6 +450,145 @@ bool VulkanContext::createSemaphore(VkSemaphore* semaphore) const {
     return true;
 }
 
+bool VulkanContext::createFence(VulkanFence* fence) const {
+    if (fence == nullptr) return false;
+    *fence = VulkanFence(mDevice.handle());
+    const VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+    };
+    CALL_VK(vkCreateFence, mDevice.handle(), &fenceCreateInfo, nullptr, fence->pHandle());
+    return true;
+}
+
+bool VulkanContext::submit(VkCommandBuffer commandBuffer, uint64_t waitValue,
+                           uint64_t* signalValue) const {
+    return submit(commandBuffer, waitValue, signalValue, SubmitSemaphores{});
+}
+
+bool VulkanContext::submit(VkCommandBuffer commandBuffer, uint64_t waitValue,
+                           uint64_t* signalValue, const SubmitSemaphores& semaphores) const {
+    if (signalValue == nullptr) return false;
+    const bool hasWait = semaphores.wait != VK_NULL_HANDLE;
+    const bool hasSignal = semaphores.signal != VK_NULL_HANDLE;
+
+    // Without timeline semaphores, each submission is waited for on a fence before returning, so
+    // that the timeline has always reached the values handed out. The queue is only locked for
+    // the submission, so that the other threads may submit while this one waits.
+    if (!supportsTimelineSemaphore()) {
+        VulkanFence fence(mDevice.handle());
+        RET_CHECK(createFence(&fence));
+        const VkSubmitInfo submitInfo = {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .waitSemaphoreCount = hasWait ? 1u : 0u,
+                .pWaitSemaphores = &semaphores.wait,
+                .pWaitDstStageMask = &semaphores.waitStage,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &commandBuffer,
+                .signalSemaphoreCount = hasSignal ? 1u : 0u,
+                .pSignalSemaphores = &semaphores.signal,
+        };
+        {
+            std::lock_guard<std::mutex> lock(mQueueMutex);
+            RET_CHECK(waitValue <= mTimelineValue);
+            CALL_VK(vkQueueSubmit, mQueue, 1, &submitInfo, fence.handle());
+        }
+        CALL_VK(vkWaitForFences, mDevice.handle(), 1, fence.pHandle(), VK_TRUE, UINT64_MAX);
+        std::lock_guard<std::mutex> lock(mQueueMutex);
+        *signalValue = ++mTimelineValue;
+        return true;
+    }
+
+    // The timeline semaphore comes first, followed by the binary semaphores, whose values are
+    // ignored.
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<uint64_t> waitValues;
+    std::vector<VkPipelineStageFlags> waitStages;
+    if (waitValue > 0) {
+        waitSemaphores.push_back(mTimelineSemaphore.handle());
+        waitValues.push_back(waitValue);
+        waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+    if (hasWait) {
+        waitSemaphores.push_back(semaphores.wait);
+        waitValues.push_back(0);
+        waitStages.push_back(semaphores.waitStage);
+    }
+    std::vector<VkSemaphore> signalSemaphores = {mTimelineSemaphore.handle()};
+    std::vector<uint64_t> signalValues = {0};
+    if (hasSignal) {
+        signalSemaphores.push_back(semaphores.signal);
+        signalValues.push_back(0);
+    }
+
+    // The values must be signaled in increasing order, so the value is assigned under the lock.
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    RET_CHECK(waitValue <= mTimelineValue);
+    const uint64_t value = mTimelineValue + 1;
+    signalValues[0] = value;
+    const VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size()),
+            .pWaitSemaphoreValues = waitValues.data(),
+            .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()),
+            .pSignalSemaphoreValues = signalValues.data(),
+    };
+    const VkSubmitInfo submitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = &timelineSubmitInfo,
+            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+            .pWaitSemaphores = waitSemaphores.data(),
+            .pWaitDstStageMask = waitStages.data(),
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
+            .pSignalSemaphores = signalSemaphores.data(),
+    };
+    CALL_VK(vkQueueSubmit, mQueue, 1, &submitInfo, VK_NULL_HANDLE);
+    mTimelineValue = value;
+    *signalValue = value;
+    return true;
+}
+
+VkResult VulkanContext::present(VkSwapchainKHR swapchain, uint32_t imageIndex,
+                                VkSemaphore waitSemaphore) const {
+    const VkPresentInfoKHR presentInfo = {
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &waitSemaphore,
+            .swapchainCount = 1,
+            .pSwapchains = &swapchain,
+            .pImageIndices = &imageIndex,
+            .pResults = nullptr,
+    };
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    return vkQueuePresentKHR(mQueue, &presentInfo);
+}
+
+bool VulkanContext::waitQueueIdle() const {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+    CALL_VK(vkQueueWaitIdle, mQueue);
+    return true;
+}
+
+bool VulkanContext::waitForTimeline(uint64_t value) const {
+    if (value == 0 || !supportsTimelineSemaphore()) return true;
+    const VkSemaphore semaphore = mTimelineSemaphore.handle();
+    const VkSemaphoreWaitInfo waitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &value,
+    };
+    CALL_VK(mWaitSemaphores, mDevice.handle(), &waitInfo, UINT64_MAX);
+    return true;
+}
+
 bool VulkanContext::createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties,
                                  VkBuffer* buffer, VkDeviceMemory* memory) const {
     if (buffer == nullptr || memory == nullptr) return false;
@@ -282,11 +623,13 @@ bool VulkanContext::createBuffer(size_t size, VkFlags bufferUsage, VkFlags memor
 bool VulkanContext::beginSingleTimeCommand(VkCommandBuffer* commandBuffer) const {
     if (commandBuffer == nullptr) return false;
 
-    // Allocate a command buffer
+    // Allocate a command buffer from the pool of the calling thread
+    const VkCommandPool pool = commandPool();
+    RET_CHECK(pool != VK_NULL_HANDLE);
     const VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
             .pNext = nullptr,
-            .commandPool = mCommandPool.handle(),
+            .commandPool = pool,
             .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
             .commandBufferCount = 1,
     };
@@ -307,21 +650,11 @@ bool VulkanContext::endAndSubmitSingleTimeCommand(VkCommandBuffer commandBuffer)
     // End command buffer recording
     CALL_VK(vkEndCommandBuffer, commandBuffer);
 
-    // Submit command buffer to the compute queue
-    const VkSubmitInfo submitInfo = {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .waitSemaphoreCount = 0,
-            .pWaitSemaphores = nullptr,
-            .pWaitDstStageMask = nullptr,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &commandBuffer,
-            .signalSemaphoreCount = 0,
-            .pSignalSemaphores = nullptr,
-    };
-    CALL_VK(vkQueueSubmit, mQueue, 1, &submitInfo, VK_NULL_HANDLE);
-
-    // Wait for the command to finish
-    CALL_VK(vkQueueWaitIdle, mQueue);
+    // Submit command buffer to the compute queue, and wait for the command to finish. Only this
+    // submission is waited for, not the submissions of the other threads.
+    uint64_t value = 0;
+    RET_CHECK(submit(commandBuffer, /*waitValue=*/0, &value));
+    RET_CHECK(waitForTimeline(value));
     return true;
 }
 
@@ -20,48 +20,156 @@
 #include <android/bitmap.h>
 #include <android/hardware_buffer_jni.h>
 
+#include <array>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "Utils.h"
 
 namespace sample {
 
+// The command pools of the threads that have recorded single time commands with a VulkanContext,
+// keyed by the thread id. A pool is only used by its thread, the mutex only guards the map. The
+// pool of a thread is released when the thread exits, see VulkanContext::commandPool.
+struct ThreadCommandPools {
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, VulkanCommandPool> pools;
+};
+
 // VulkanContext manages the Vulkan environment and resource objects that are shared by multiple
-// compute pipelines.
+// compute pipelines and ImageProcessors. The descriptor pools, the command buffers and the
+// resources belong to their users, so that they are released with them.
+//
+// The methods of VulkanContext may be called from multiple threads. Command pools are not thread
+// safe, so each thread records its single time commands with its own command pool, and long-lived
+// command buffers should be allocated from a command pool created with createCommandPool. The
+// queue is shared by all the threads, submissions must go through VulkanContext::submit.
+//
+// The submissions are ordered by a timeline: each of them signals the next value of the timeline
+// when finished. Dependent work, on the device or on the host, waits for the value it depends on
+// rather than for the whole queue to be idle.
 class VulkanContext {
    public:
     // Create the managed Vulkan objects. If enableDebug is true, the Vulkan instance will be
     // created with the validation layer "VK_LAYER_KHRONOS_validation".
     static std::unique_ptr<VulkanContext> create(bool enableDebug);
 
-    // Prefer VulkanContext::create
-    VulkanContext() : mDescriptorPool(VK_NULL_HANDLE), mCommandPool(VK_NULL_HANDLE) {}
+    // Get the context shared within the process, or create one if there is none alive. enableDebug
+    // only takes effect when the context is created. The context is destroyed when the last
+    // reference is released, so that an idle app does not hold on to the Vulkan device.
+    // Return nullptr if failed.
+    static std::shared_ptr<VulkanContext> getShared(bool enableDebug);
+
+    // Prefer VulkanContext::create or VulkanContext::getShared
+    VulkanContext()
+        : mTimelineSemaphore(VK_NULL_HANDLE),
+          mThreadCommandPools(std::make_shared<ThreadCommandPools>()) {}
+
+    ~VulkanContext();
 
     // Getters of the managed Vulkan objects
+    VkInstance instance() const { return mInstance.handle(); }
+    VkPhysicalDevice physicalDevice() const { return mPhysicalDevice; }
     VkDevice device() const { return mDevice.handle(); }
-    VkQueue queue() const { return mQueue; }
-    VkCommandPool commandPool() const { return mCommandPool.handle(); }
-    VkDescriptorPool descriptorPool() const { return mDescriptorPool.handle(); }
+    uint32_t queueFamilyIndex() const { return mQueueFamilyIndex; }
+
+    // Get the command pool of the calling thread, the pool is created on the first call from each
+    // thread, and destroyed when the thread exits or the context is destroyed, whichever comes
+    // first. Return VK_NULL_HANDLE if failed.
+    VkCommandPool commandPool() const;
 
     uint32_t getWorkGroupSize() const { return mWorkGroupSize; }
 
+    // Return true if the compute shaders may use all of the given subgroup operations. Subgroup
+    // operations require Vulkan 1.1.
+    bool supportsSubgroupOperations(VkSubgroupFeatureFlags operations) const {
+        return (mSubgroupOperations & operations) == operations;
+    }
+
+    // Return true if the timeline is backed by a timeline semaphore, which requires
+    // VK_KHR_timeline_semaphore. Otherwise, VulkanContext::submit waits for each submission to
+    // finish before returning.
+    bool supportsTimelineSemaphore() const { return mTimelineSemaphore.handle() != VK_NULL_HANDLE; }
+
+    // Return true if the images may be presented to an ANativeWindow, which requires
+    // VK_KHR_android_surface and VK_KHR_swapchain.
+    bool supportsPresentation() const { return mPresentationEnabled; }
+
     // Find a suitable memory type that matches the memoryTypeBits and the required properties.
     std::optional<uint32_t> findMemoryType(uint32_t memoryTypeBits, VkFlags properties) const;
 
+    // Account the device memory allocated or freed by DeviceMemory to the heap of the memory type.
+    void onMemoryAllocated(uint32_t memoryTypeIndex, VkDeviceSize size) const;
+    void onMemoryFreed(uint32_t memoryTypeIndex, VkDeviceSize size) const;
+
+    // The budget and the usage of the device local memory heaps in bytes.
+    struct MemoryBudget {
+        VkDeviceSize budget = 0;
+        VkDeviceSize usage = 0;
+    };
+
+    // Get the budget and the usage of the device local memory. With VK_EXT_memory_budget, both are
+    // reported by the driver, and the usage includes the allocations of the process made outside
+    // of this context. Otherwise, the budget is the heap size, and the usage only counts the
+    // memory allocated through DeviceMemory.
+    MemoryBudget getDeviceLocalMemoryBudget() const;
+
     // Create a semaphore with the managed device.
     bool createSemaphore(VkSemaphore* semaphore) const;
 
+    // Create an unsignaled fence with the managed device.
+    bool createFence(VulkanFence* fence) const;
+
+    // Create a command pool of the compute queue family. The caller owns the pool and must
+    // externally synchronize the access to it.
+    bool createCommandPool(VulkanCommandPool* commandPool) const;
+
+    // Submit the command buffer to the compute queue. If waitValue is not 0, the command buffer
+    // does not start until the timeline reaches waitValue. On success, signalValue is set to the
+    // timeline value that is signaled when the command buffer finishes. This is safe to call from
+    // multiple threads, the queue is only locked for the duration of vkQueueSubmit.
+    bool submit(VkCommandBuffer commandBuffer, uint64_t waitValue, uint64_t* signalValue) const;
+
+    // The binary semaphores of a submission, e.g. to acquire and present a swapchain image. Each
+    // of them may be VK_NULL_HANDLE.
+    struct SubmitSemaphores {
+        VkSemaphore wait = VK_NULL_HANDLE;
+        VkPipelineStageFlags waitStage = 0;
+        VkSemaphore signal = VK_NULL_HANDLE;
+    };
+
+    // Same as above, but also wait for semaphores.wait at semaphores.waitStage, and signal
+    // semaphores.signal when the command buffer finishes.
+    bool submit(VkCommandBuffer commandBuffer, uint64_t waitValue, uint64_t* signalValue,
+                const SubmitSemaphores& semaphores) const;
+
+    // Queue the presentation of the swapchain image after waitSemaphore is signaled. Return the
+    // result of vkQueuePresentKHR.
+    VkResult present(VkSwapchainKHR swapchain, uint32_t imageIndex,
+                     VkSemaphore waitSemaphore) const;
+
+    // Block the calling thread until the queue is idle, including the queued presentations. The
+    // queue is locked meanwhile, so prefer waitForTimeline for the submissions.
+    bool waitQueueIdle() const;
+
+    // Block the calling thread until the timeline reaches value, which must have been returned by
+    // VulkanContext::submit. Return true immediately if value is 0.
+    bool waitForTimeline(uint64_t value) const;
+
     // Create a buffer and its memory.
     bool createBuffer(size_t size, VkFlags bufferUsage, VkFlags memoryProperties, VkBuffer* buffer,
                       VkDeviceMemory* memory) const;
 
-    // Create a command buffer with VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, and begin command
-    // buffer recording.
+    // Create a command buffer from the command pool of the calling thread with
+    // VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, and begin command buffer recording.
     bool beginSingleTimeCommand(VkCommandBuffer* commandBuffer) const;
 
     // End the command buffer recording, submit it to the queue, and wait until it is finished.
+    // Only this submission is waited for, other threads may keep the queue busy meanwhile.
     bool endAndSubmitSingleTimeCommand(VkCommandBuffer commandBuffer) const;
 
    private:
@@ -70,7 +178,7 @@ class VulkanContext {
     bool createInstance(bool enableDebug);
     bool pickPhysicalDeviceAndQueueFamily();
     bool createDevice();
-    bool createPools();
+    bool createTimelineSemaphore();
 
     // Instance
     uint32_t mInstanceVersion = 0;
@@ -82,14 +190,34 @@ class VulkanContext {
     VkPhysicalDeviceMemoryProperties mPhysicalDeviceMemoryProperties;
     uint32_t mQueueFamilyIndex = 0;
     uint32_t mWorkGroupSize = 0;
+    VkSubgroupFeatureFlags mSubgroupOperations = 0;
 
-    // Logical device and queue
+    // Logical device and queue. The queue must be externally synchronized, mQueueMutex guards
+    // all the accesses to it.
     VulkanDevice mDevice;
     VkQueue mQueue = VK_NULL_HANDLE;
-
-    // Pools
-    VulkanDescriptorPool mDescriptorPool;
-    VulkanCommandPool mCommandPool;
+    mutable std::mutex mQueueMutex;
+
+    // The optional extensions enabled on the instance and the device.
+    bool mTimelineSemaphoreEnabled = false;
+    bool mMemoryBudgetEnabled = false;
+    bool mSurfaceEnabled = false;
+    bool mPresentationEnabled = false;
+
+    // The timeline semaphore, or VK_NULL_HANDLE if not supported, and the value signaled by the
+    // latest submission, which is guarded by mQueueMutex. The timeline semaphore functions are
+    // not exported by the Android loader before Vulkan 1.2, they are loaded from the device.
+    VulkanSemaphore mTimelineSemaphore;
+    mutable uint64_t mTimelineValue = 0;
+    PFN_vkWaitSemaphoresKHR mWaitSemaphores = nullptr;
+
+    // The device memory allocated through DeviceMemory of each memory heap.
+    mutable std::mutex mMemoryMutex;
+    mutable std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> mHeapUsage = {};
+
+    // Shared with the threads that have recorded single time commands, which release their pools
+    // on exit if the context is still alive.
+    std::shared_ptr<ThreadCommandPools> mThreadCommandPools;
 };
 
 }  // namespace sample
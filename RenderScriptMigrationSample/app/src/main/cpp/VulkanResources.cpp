@@ -20,6 +20,7 @@
 #include <android/hardware_buffer_jni.h>
 #include <jni.h>
 
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -29,6 +30,15 @@
 
 namespace sample {
 
+bool DeviceMemory::allocate(const VkMemoryAllocateInfo& allocateInfo) {
+    RET_CHECK(mSize == 0);
+    CALL_VK(vkAllocateMemory, mContext->device(), &allocateInfo, nullptr, mMemory.pHandle());
+    mMemoryTypeIndex = allocateInfo.memoryTypeIndex;
+    mSize = allocateInfo.allocationSize;
+    mContext->onMemoryAllocated(mMemoryTypeIndex, mSize);
+    return true;
+}
+
 std::unique_ptr<Buffer> Buffer::create(const VulkanContext* context, uint32_t size,
                                        VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
     auto buffer = std::make_unique<Buffer>(context, size);
@@ -58,7 +68,7 @@ bool Buffer::initialize(VkBufferUsageFlags usage, VkMemoryPropertyFlags properti
             .allocationSize = memoryRequirements.size,
             .memoryTypeIndex = memoryTypeIndex.value(),
     };
-    CALL_VK(vkAllocateMemory, mContext->device(), &allocateInfo, nullptr, mMemory.pHandle());
+    RET_CHECK(mMemory.allocate(allocateInfo));
 
     vkBindBufferMemory(mContext->device(), mBuffer.handle(), mMemory.handle(), 0);
     return true;
@@ -72,9 +82,30 @@ bool Buffer::copyFrom(const void* data) {
     return true;
 }
 
+bool Buffer::copyTo(void* data) const {
+    void* bufferData = nullptr;
+    CALL_VK(vkMapMemory, mContext->device(), mMemory.handle(), 0, mSize, 0, &bufferData);
+    memcpy(data, bufferData, mSize);
+    vkUnmapMemory(mContext->device(), mMemory.handle());
+    return true;
+}
+
+void* Buffer::map() {
+    if (mMappedData == nullptr) {
+        const VkResult result = vkMapMemory(mContext->device(), mMemory.handle(), 0, mSize, 0,
+                                            &mMappedData);
+        if (result != VK_SUCCESS) {
+            LOGE("Buffer::map: vkMapMemory failed with %s", vkResultToStr(result));
+            mMappedData = nullptr;
+        }
+    }
+    return mMappedData;
+}
+
 std::unique_ptr<Image> Image::createDeviceLocal(const VulkanContext* context, uint32_t width,
-                                                uint32_t height, VkImageUsageFlags usage) {
-    auto image = std::make_unique<Image>(context, width, height);
+                                                uint32_t height, VkImageUsageFlags usage,
+                                                VkFormat format) {
+    auto image = std::make_unique<Image>(context, width, height, format);
     bool success = image->createDeviceLocalImage(usage) && image->createImageView();
     // Sampler is only needed for sampled images.
     if (usage & VK_IMAGE_USAGE_SAMPLED_BIT) {
@@ -83,6 +114,14 @@ std::unique_ptr<Image> Image::createDeviceLocal(const VulkanContext* context, ui
     return success ? std::move(image) : nullptr;
 }
 
+std::unique_ptr<Image> Image::createUnbound(const VulkanContext* context, uint32_t width,
+                                            uint32_t height, VkImageUsageFlags usage,
+                                            VkFormat format) {
+    auto image = std::make_unique<Image>(context, width, height, format);
+    const bool success = image->createImage(usage);
+    return success ? std::move(image) : nullptr;
+}
+
 std::unique_ptr<Image> Image::createFromBitmap(const VulkanContext* context, JNIEnv* env,
                                                jobject bitmap) {
     // Get bitmap info
@@ -99,7 +138,8 @@ std::unique_ptr<Image> Image::createFromBitmap(const VulkanContext* context, JNI
     if (image == nullptr) return nullptr;
 
     // Set content from bitmap
-    const bool success = image->setContentFromBitmap(env, bitmap);
+    const bool success =
+            image->setContentFromBitmap(env, bitmap, {{0, 0}, {info.width, info.height}});
     return success ? std::move(image) : nullptr;
 }
 
@@ -110,14 +150,15 @@ std::unique_ptr<Image> Image::createFromAHardwareBuffer(const VulkanContext* con
     return success ? std::move(image) : nullptr;
 }
 
-bool Image::createDeviceLocalImage(VkImageUsageFlags usage) {
+bool Image::createImage(VkImageUsageFlags usage) {
+    mUsage = usage;
     // Create an image
     const VkImageCreateInfo imageCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
             .pNext = nullptr,
             .flags = 0,
             .imageType = VK_IMAGE_TYPE_2D,
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .format = mFormat,
             .extent = {mWidth, mHeight, 1},
             .mipLevels = 1,
             .arrayLayers = 1,
@@ -130,6 +171,11 @@ bool Image::createDeviceLocalImage(VkImageUsageFlags usage) {
             .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
     CALL_VK(vkCreateImage, mContext->device(), &imageCreateInfo, nullptr, mImage.pHandle());
+    return true;
+}
+
+bool Image::createDeviceLocalImage(VkImageUsageFlags usage) {
+    RET_CHECK(createImage(usage));
 
     // Allocate device memory
     VkMemoryRequirements memoryRequirements;
@@ -143,32 +189,58 @@ bool Image::createDeviceLocalImage(VkImageUsageFlags usage) {
             .allocationSize = memoryRequirements.size,
             .memoryTypeIndex = memoryTypeIndex.value(),
     };
-    CALL_VK(vkAllocateMemory, mContext->device(), &allocateInfo, nullptr, mMemory.pHandle());
+    RET_CHECK(mMemory.allocate(allocateInfo));
     vkBindImageMemory(mContext->device(), mImage.handle(), mMemory.handle(), 0);
     return true;
 }
 
-bool Image::setContentFromBitmap(JNIEnv* env, jobject bitmap) {
+VkMemoryRequirements Image::getMemoryRequirements() const {
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(mContext->device(), mImage.handle(), &memoryRequirements);
+    return memoryRequirements;
+}
+
+bool Image::bindMemory(VkDeviceMemory memory, VkDeviceSize offset) {
+    CALL_VK(vkBindImageMemory, mContext->device(), mImage.handle(), memory, offset);
+    mAliased = true;
+    RET_CHECK(createImageView());
+    // Sampler is only needed for sampled images.
+    if (mUsage & VK_IMAGE_USAGE_SAMPLED_BIT) {
+        RET_CHECK(createSampler());
+    }
+    return true;
+}
+
+bool Image::setContentFromBitmap(JNIEnv* env, jobject bitmap, const VkRect2D& rect) {
     // Get bitmap info
     AndroidBitmapInfo info;
     RET_CHECK(AndroidBitmap_getInfo(env, bitmap, &info) == ANDROID_BITMAP_RESULT_SUCCESS);
     RET_CHECK(info.width == mWidth);
     RET_CHECK(info.height == mHeight);
     RET_CHECK(info.format == ANDROID_BITMAP_FORMAT_RGBA_8888);
-    RET_CHECK(info.stride % 4 == 0);
-
-    // Allocate a staging buffer
-    const uint32_t bufferSize = info.stride * info.height;
+    RET_CHECK(rect.offset.x >= 0 && rect.offset.y >= 0);
+    RET_CHECK(rect.extent.width > 0 && rect.extent.height > 0);
+    const auto x = static_cast<uint32_t>(rect.offset.x);
+    const auto y = static_cast<uint32_t>(rect.offset.y);
+    RET_CHECK(x + rect.extent.width <= mWidth && y + rect.extent.height <= mHeight);
+
+    // Allocate a staging buffer holding the tightly packed rows of the rect
+    const uint32_t rowSize = rect.extent.width * 4;
     auto stagingBuffer = Buffer::create(
-            mContext, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            mContext, rowSize * rect.extent.height, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    RET_CHECK(stagingBuffer != nullptr);
+    auto* bufferData = static_cast<uint8_t*>(stagingBuffer->map());
+    RET_CHECK(bufferData != nullptr);
 
-    // Copy bitmap pixels to the buffer memory
+    // Copy bitmap pixels within the rect to the buffer memory
     void* bitmapData = nullptr;
     RET_CHECK(AndroidBitmap_lockPixels(env, bitmap, &bitmapData) == ANDROID_BITMAP_RESULT_SUCCESS);
-    const bool success = stagingBuffer->copyFrom(bitmapData);
+    const uint8_t* rectData = static_cast<const uint8_t*>(bitmapData) + y * info.stride + x * 4;
+    for (uint32_t row = 0; row < rect.extent.height; row++) {
+        memcpy(bufferData + row * rowSize, rectData + row * info.stride, rowSize);
+    }
     AndroidBitmap_unlockPixels(env, bitmap);
-    RET_CHECK(success);
 
     // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
     RET_CHECK(transitionLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
@@ -178,11 +250,11 @@ bool Image::setContentFromBitmap(JNIEnv* env, jobject bitmap) {
     RET_CHECK(mContext->beginSingleTimeCommand(copyCommand.pHandle()));
     const VkBufferImageCopy bufferImageCopy = {
             .bufferOffset = 0,
-            .bufferRowLength = info.stride / 4,
-            .bufferImageHeight = mHeight,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
             .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-            .imageOffset = {0, 0, 0},
-            .imageExtent = {mWidth, mHeight, 1},
+            .imageOffset = {rect.offset.x, rect.offset.y, 0},
+            .imageExtent = {rect.extent.width, rect.extent.height, 1},
     };
     vkCmdCopyBufferToImage(copyCommand.handle(), stagingBuffer->getBufferHandle(), mImage.handle(),
                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
@@ -230,7 +302,7 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer* buffer) {
             .arrayLayers = 1u,
             .samples = VK_SAMPLE_COUNT_1_BIT,
             .tiling = VK_IMAGE_TILING_OPTIMAL,
-            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
             .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
             .queueFamilyIndexCount = 0,
             .pQueueFamilyIndices = nullptr,
@@ -259,7 +331,7 @@ bool Image::createImageFromAHardwareBuffer(AHardwareBuffer* buffer) {
             .allocationSize = properties.allocationSize,
             .memoryTypeIndex = memoryTypeIndex.value(),
     };
-    CALL_VK(vkAllocateMemory, mContext->device(), &allocateInfo, nullptr, mMemory.pHandle());
+    RET_CHECK(mMemory.allocate(allocateInfo));
 
     // Bind image to the device memory
     CALL_VK(vkBindImageMemory, mContext->device(), mImage.handle(), mMemory.handle(), 0);
@@ -301,7 +373,7 @@ bool Image::createImageView() {
             .flags = 0,
             .image = mImage.handle(),
             .viewType = VK_IMAGE_VIEW_TYPE_2D,
-            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .format = mFormat,
             .components =
                     {
                             VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -354,10 +426,19 @@ void Image::recordLayoutTransitionBarrier(VkCommandBuffer cmd, VkImageLayout new
         }
     };
 
+    // The aliased memory may have been accessed through another image since the content was
+    // discarded, so the barrier must also wait for the compute and transfer accesses before it.
+    VkAccessFlags srcAccessMask = getAccessMask(mLayout);
+    VkPipelineStageFlags srcStageMask = getStageFlag(mLayout);
+    if (mAliased && mLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+
     const VkImageMemoryBarrier barrier = {
             .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
             .pNext = nullptr,
-            .srcAccessMask = getAccessMask(mLayout),
+            .srcAccessMask = srcAccessMask,
             .dstAccessMask = getAccessMask(newLayout),
             .oldLayout = mLayout,
             .newLayout = newLayout,
@@ -366,8 +447,8 @@ void Image::recordLayoutTransitionBarrier(VkCommandBuffer cmd, VkImageLayout new
             .image = mImage.handle(),
             .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
     };
-    vkCmdPipelineBarrier(cmd, getStageFlag(mLayout), getStageFlag(newLayout), 0, 0, nullptr, 0,
-                         nullptr, 1, &barrier);
+    vkCmdPipelineBarrier(cmd, srcStageMask, getStageFlag(newLayout), 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
     mLayout = newLayout;
 }
 
@@ -380,4 +461,152 @@ bool Image::transitionLayout(VkImageLayout newLayout) {
     return true;
 }
 
+std::unique_ptr<Lut3D> Lut3D::create(const VulkanContext* context, const uint8_t* table,
+                                     uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ) {
+    if (table == nullptr || sizeX == 0 || sizeY == 0 || sizeZ == 0) {
+        LOGE("Lut3D::create: Invalid lookup table");
+        return nullptr;
+    }
+    auto lut = std::make_unique<Lut3D>(context, sizeX, sizeY, sizeZ);
+    const bool success = lut->createImage() && lut->createImageView() && lut->createSampler() &&
+                         lut->setContent(table);
+    return success ? std::move(lut) : nullptr;
+}
+
+bool Lut3D::createImage() {
+    // Create a 3D image
+    const VkImageCreateInfo imageCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .imageType = VK_IMAGE_TYPE_3D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .extent = {mSizeX, mSizeY, mSizeZ},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 0,
+            .pQueueFamilyIndices = nullptr,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    CALL_VK(vkCreateImage, mContext->device(), &imageCreateInfo, nullptr, mImage.pHandle());
+
+    // Allocate device memory
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(mContext->device(), mImage.handle(), &memoryRequirements);
+    const auto memoryTypeIndex = mContext->findMemoryType(memoryRequirements.memoryTypeBits,
+                                                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    RET_CHECK(memoryTypeIndex.has_value());
+    const VkMemoryAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .allocationSize = memoryRequirements.size,
+            .memoryTypeIndex = memoryTypeIndex.value(),
+    };
+    RET_CHECK(mMemory.allocate(allocateInfo));
+    vkBindImageMemory(mContext->device(), mImage.handle(), mMemory.handle(), 0);
+    return true;
+}
+
+bool Lut3D::createSampler() {
+    const VkSamplerCreateInfo samplerCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+            .pNext = nullptr,
+            .magFilter = VK_FILTER_LINEAR,
+            .minFilter = VK_FILTER_LINEAR,
+            .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+            .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+            .mipLodBias = 0.0f,
+            .anisotropyEnable = VK_FALSE,
+            .maxAnisotropy = 1,
+            .compareEnable = VK_FALSE,
+            .compareOp = VK_COMPARE_OP_NEVER,
+            .minLod = 0.0f,
+            .maxLod = 0.0f,
+            .borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+            // Unnormalized coordinates are not supported with 3D images
+            .unnormalizedCoordinates = VK_FALSE,
+    };
+    CALL_VK(vkCreateSampler, mContext->device(), &samplerCreateInfo, nullptr, mSampler.pHandle());
+    return true;
+}
+
+bool Lut3D::createImageView() {
+    const VkImageViewCreateInfo viewCreateInfo{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .image = mImage.handle(),
+            .viewType = VK_IMAGE_VIEW_TYPE_3D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .components =
+                    {
+                            VK_COMPONENT_SWIZZLE_IDENTITY,
+                            VK_COMPONENT_SWIZZLE_IDENTITY,
+                            VK_COMPONENT_SWIZZLE_IDENTITY,
+                            VK_COMPONENT_SWIZZLE_IDENTITY,
+                    },
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+    CALL_VK(vkCreateImageView, mContext->device(), &viewCreateInfo, nullptr, mImageView.pHandle());
+    return true;
+}
+
+bool Lut3D::setContent(const uint8_t* table) {
+    // Copy the table to a staging buffer
+    const uint32_t bufferSize = mSizeX * mSizeY * mSizeZ * 4;
+    auto stagingBuffer = Buffer::create(
+            mContext, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    RET_CHECK(stagingBuffer != nullptr);
+    RET_CHECK(stagingBuffer->copyFrom(table));
+
+    VulkanCommandBuffer copyCommand(mContext->device(), mContext->commandPool());
+    RET_CHECK(mContext->beginSingleTimeCommand(copyCommand.pHandle()));
+
+    // Set layout to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to prepare for buffer-image copy
+    VkImageMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = mImage.handle(),
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+    vkCmdPipelineBarrier(copyCommand.handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    // Copy buffer to image
+    const VkBufferImageCopy bufferImageCopy = {
+            .bufferOffset = 0,
+            .bufferRowLength = mSizeX,
+            .bufferImageHeight = mSizeY,
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {mSizeX, mSizeY, mSizeZ},
+    };
+    vkCmdCopyBufferToImage(copyCommand.handle(), stagingBuffer->getBufferHandle(), mImage.handle(),
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+
+    // Set layout to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL to prepare for sampler usage
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(copyCommand.handle(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+    RET_CHECK(mContext->endAndSubmitSingleTimeCommand(copyCommand.handle()));
+    return true;
+}
+
 }  // namespace sample
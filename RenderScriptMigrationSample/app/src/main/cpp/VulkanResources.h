@@ -30,6 +30,29 @@
 
 namespace sample {
 
+// Device memory that is accounted to its memory heap in the VulkanContext while allocated.
+class DeviceMemory {
+   public:
+    explicit DeviceMemory(const VulkanContext* context)
+        : mContext(context), mMemory(context->device()) {}
+
+    ~DeviceMemory() {
+        if (mSize > 0) mContext->onMemoryFreed(mMemoryTypeIndex, mSize);
+    }
+
+    // Allocate the memory, which must not have been allocated.
+    bool allocate(const VkMemoryAllocateInfo& allocateInfo);
+
+    VkDeviceMemory handle() const { return mMemory.handle(); }
+    VkDeviceSize size() const { return mSize; }
+
+   private:
+    const VulkanContext* mContext;
+    uint32_t mMemoryTypeIndex = 0;
+    VkDeviceSize mSize = 0;
+    VulkanDeviceMemory mMemory;
+};
+
 class Buffer {
    public:
     // Create a buffer and allocate the memory.
@@ -39,12 +62,22 @@ class Buffer {
 
     // Prefer Buffer::create
     Buffer(const VulkanContext* context, uint32_t size)
-        : mContext(context), mSize(size), mBuffer(context->device()), mMemory(context->device()) {}
+        : mContext(context), mSize(size), mBuffer(context->device()), mMemory(context) {}
 
     // Set the buffer content from the data. The buffer must be created with host-visible and
     // host-coherent properties.
     bool copyFrom(const void* data);
 
+    // Copy the buffer content to data. The buffer must be created with host-visible and
+    // host-coherent properties.
+    bool copyTo(void* data) const;
+
+    // Map the memory on the first call, and return the host address of the mapped memory. The
+    // memory stays mapped until the buffer is destroyed. The buffer must be created with
+    // host-visible and host-coherent properties, and must not use Buffer::copyFrom or
+    // Buffer::copyTo. Return nullptr if failed.
+    void* map();
+
     VkBuffer getBufferHandle() const { return mBuffer.handle(); }
     VkDescriptorBufferInfo getDescriptor() const { return {mBuffer.handle(), 0, mSize}; }
 
@@ -53,10 +86,11 @@ class Buffer {
 
     const VulkanContext* mContext;
     uint32_t mSize;
+    void* mMappedData = nullptr;
 
     // Managed handles
     VulkanBuffer mBuffer;
-    VulkanDeviceMemory mMemory;
+    DeviceMemory mMemory;
 };
 
 class Image {
@@ -64,7 +98,15 @@ class Image {
     // Create a image backed by device local memory. The layout is VK_IMAGE_LAYOUT_UNDEFINED
     // after the creation.
     static std::unique_ptr<Image> createDeviceLocal(const VulkanContext* context, uint32_t width,
-                                                    uint32_t height, VkImageUsageFlags usage);
+                                                    uint32_t height, VkImageUsageFlags usage,
+                                                    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+
+    // Create a image without memory. The memory is bound later with Image::bindMemory, and may be
+    // aliased with the memory of other images, see TransientAllocator. The layout is
+    // VK_IMAGE_LAYOUT_UNDEFINED after the creation.
+    static std::unique_ptr<Image> createUnbound(const VulkanContext* context, uint32_t width,
+                                                uint32_t height, VkImageUsageFlags usage,
+                                                VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
 
     // Create a image backed by device local memory, and initialize the memory from a bitmap image.
     // The image is created with usage VK_IMAGE_USAGE_TRANSFER_DST_BIT and
@@ -75,19 +117,22 @@ class Image {
 
     // Create a image backed by the given AHardwareBuffer. The image will keep a reference to the
     // AHardwareBuffer so that callers can safely close buffer.
-    // The image is created with usage VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+    // The image is created with usage VK_IMAGE_USAGE_TRANSFER_DST_BIT and
+    // VK_IMAGE_USAGE_TRANSFER_SRC_BIT, so that it can be read back to the host.
     // The layout is set to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL after the creation.
     static std::unique_ptr<Image> createFromAHardwareBuffer(const VulkanContext* context,
                                                             AHardwareBuffer* buffer);
 
     // Prefer static factory methods
     Image(const VulkanContext* context) : Image(context, 0u, 0u) {}
-    Image(const VulkanContext* context, uint32_t width, uint32_t height)
+    Image(const VulkanContext* context, uint32_t width, uint32_t height,
+          VkFormat format = VK_FORMAT_R8G8B8A8_UNORM)
         : mContext(context),
           mWidth(width),
           mHeight(height),
+          mFormat(format),
           mImage(context->device()),
-          mMemory(context->device()),
+          mMemory(context),
           mSampler(context->device()),
           mImageView(context->device()) {}
 
@@ -100,6 +145,8 @@ class Image {
     uint32_t width() const { return mWidth; }
     uint32_t height() const { return mHeight; }
     VkImage getImageHandle() const { return mImage.handle(); }
+    VkDeviceSize memorySize() const { return mMemory.size(); }
+    VkMemoryRequirements getMemoryRequirements() const;
     AHardwareBuffer* getAHardwareBuffer() { return mBuffer; }
     VkDescriptorImageInfo getDescriptor() const {
         return {mSampler.handle(), mImageView.handle(), mLayout};
@@ -111,16 +158,32 @@ class Image {
     void recordLayoutTransitionBarrier(VkCommandBuffer cmd, VkImageLayout newLayout,
                                        bool preserveData = true);
 
+    // Bind the image created with Image::createUnbound to the memory at offset, and create the
+    // image view and the sampler.
+    bool bindMemory(VkDeviceMemory memory, VkDeviceSize offset);
+
+    // Treat the image content as undefined, e.g. after the aliased memory has been used by another
+    // image. The next layout transition discards the content.
+    void discardContent() { mLayout = VK_IMAGE_LAYOUT_UNDEFINED; }
+
+    // Copy the bitmap pixels within rect to the same rect of the image created with
+    // Image::createFromBitmap, e.g. after an edit of the bitmap. The bitmap must have the image
+    // size. Only the rows of the rect are staged, and the call blocks until the copy has finished.
+    bool updateFromBitmap(JNIEnv* env, jobject bitmap, const VkRect2D& rect) {
+        return setContentFromBitmap(env, bitmap, rect);
+    }
+
    private:
     // Initialization
+    bool createImage(VkImageUsageFlags usage);
     bool createDeviceLocalImage(VkImageUsageFlags usage);
     bool createImageFromAHardwareBuffer(AHardwareBuffer* buffer);
     bool createSampler();
     bool createImageView();
 
-    // Copy the bitmap pixels to the image device memory. The image must be created with
-    // VK_IMAGE_USAGE_TRANSFER_DST_BIT.
-    bool setContentFromBitmap(JNIEnv* env, jobject bitmap);
+    // Copy the bitmap pixels within rect to the image device memory. The image must be created
+    // with VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+    bool setContentFromBitmap(JNIEnv* env, jobject bitmap, const VkRect2D& rect);
 
     // Change the image layout from mLayout to newLayout.
     bool transitionLayout(VkImageLayout newLayout);
@@ -130,6 +193,11 @@ class Image {
 
     uint32_t mWidth;
     uint32_t mHeight;
+    VkFormat mFormat;
+    VkImageUsageFlags mUsage = 0;
+
+    // Whether the memory is bound with Image::bindMemory and may be aliased.
+    bool mAliased = false;
 
     // The managed AHardwareBuffer handle. Only valid if the image is created from
     // Image::createFromAHardwareBuffer.
@@ -137,12 +205,60 @@ class Image {
 
     // Managed handles
     VulkanImage mImage;
-    VulkanDeviceMemory mMemory;
+    DeviceMemory mMemory;
     VulkanSampler mSampler;
     VulkanImageView mImageView;
     VkImageLayout mLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 };
 
+// A 3D lookup table of RGBA colors indexed by the RGB color. The table is sampled with trilinear
+// filtering and normalized coordinates.
+class Lut3D {
+   public:
+    // Create a 3D lookup table and upload the table content. The table is an array of RGBA_8888
+    // colors with the red index increasing the fastest, then green, then blue, i.e. the entry
+    // (r, g, b) is at (b * sizeY + g) * sizeX + r. The image layout is
+    // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL after the creation.
+    static std::unique_ptr<Lut3D> create(const VulkanContext* context, const uint8_t* table,
+                                         uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ);
+
+    // Prefer Lut3D::create
+    Lut3D(const VulkanContext* context, uint32_t sizeX, uint32_t sizeY, uint32_t sizeZ)
+        : mContext(context),
+          mSizeX(sizeX),
+          mSizeY(sizeY),
+          mSizeZ(sizeZ),
+          mImage(context->device()),
+          mMemory(context),
+          mSampler(context->device()),
+          mImageView(context->device()) {}
+
+    VkDeviceSize memorySize() const { return mMemory.size(); }
+    VkDescriptorImageInfo getDescriptor() const {
+        return {mSampler.handle(), mImageView.handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+
+   private:
+    // Initialization
+    bool createImage();
+    bool createSampler();
+    bool createImageView();
+    bool setContent(const uint8_t* table);
+
+    // Context
+    const VulkanContext* mContext;
+
+    uint32_t mSizeX;
+    uint32_t mSizeY;
+    uint32_t mSizeZ;
+
+    // Managed handles
+    VulkanImage mImage;
+    DeviceMemory mMemory;
+    VulkanSampler mSampler;
+    VulkanImageView mImageView;
+};
+
 }  // namespace sample
 
 #endif  // RENDERSCRIPT_MIGRATION_SAMPLE_VULKAN_RESOURCES_H
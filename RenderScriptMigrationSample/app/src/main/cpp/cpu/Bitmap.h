@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BITMAP_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BITMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace sample {
+namespace cpu {
+
+// A non-owning view of an RGBA_8888 image in host memory, with the same memory layout as an
+// Android bitmap locked by AndroidBitmap_lockPixels. The stride is the number of bytes between
+// the starts of two consecutive rows, and must be at least width * 4.
+struct BitmapView {
+    uint8_t* pixels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    size_t stride = 0;
+
+    uint8_t* row(uint32_t y) const { return pixels + y * stride; }
+    uint8_t* pixel(uint32_t x, uint32_t y) const { return row(y) + x * 4; }
+};
+
+// An RGBA pixel in float, mapped to a NEON or SSE register by the compiler.
+using float4 = float __attribute__((vector_size(16)));
+
+// Convert a channel value within [0, 255] to 8 bits, rounding to the nearest and saturating, the
+// same as the conversion of the rgba8 storage images.
+inline uint8_t toUnorm8(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+}
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BITMAP_H
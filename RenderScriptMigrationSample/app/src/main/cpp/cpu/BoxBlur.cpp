@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BoxBlur.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Bitmap.h"
+
+namespace sample {
+namespace cpu {
+namespace {
+
+// Divide the box sums by the window size with a fixed-point reciprocal. The window sums of 8-bit
+// values never exceed 255 * (2 * radius + 1), so the product fits in 64 bits for any radius.
+class BoxDivider {
+   public:
+    explicit BoxDivider(int32_t radius)
+        : mReciprocal(((uint64_t{1} << kShift) + static_cast<uint64_t>(radius)) /
+                      (2 * static_cast<uint64_t>(radius) + 1)) {}
+
+    uint8_t operator()(uint32_t sum) const {
+        return static_cast<uint8_t>((sum * mReciprocal + (uint64_t{1} << (kShift - 1))) >> kShift);
+    }
+
+   private:
+    static constexpr uint32_t kShift = 24;
+    uint64_t mReciprocal;
+};
+
+// Add the RGB channels of the clamped window [-radius, radius] around position 0 to sum. The
+// out-of-range taps repeat the edge pixels, so they are accounted for with multiplications
+// instead of a loop over the whole window.
+void primeWindow(const uint8_t* line, size_t pixelStride, int32_t length, int32_t radius,
+                 uint32_t* sum) {
+    const uint8_t* first = line;
+    const uint8_t* last = line + static_cast<size_t>(length - 1) * pixelStride;
+    const int32_t inRange = std::min(radius, length - 1);
+    const uint32_t numFirst = static_cast<uint32_t>(radius);
+    const uint32_t numLast = static_cast<uint32_t>(radius - inRange);
+    for (int32_t c = 0; c < 3; c++) {
+        sum[c] = numFirst * first[c] + numLast * last[c];
+    }
+    for (int32_t i = 0; i <= inRange; i++) {
+        const uint8_t* p = line + static_cast<size_t>(i) * pixelStride;
+        for (int32_t c = 0; c < 3; c++) sum[c] += p[c];
+    }
+}
+
+// Blur a line of pixels in place of out with a box filter, clamping to edge. The consecutive
+// pixels of the line are pixelStride bytes apart in both in and out.
+void boxBlurLine(const uint8_t* in, uint8_t* out, size_t pixelStride, int32_t length,
+                 int32_t radius) {
+    const BoxDivider divide(radius);
+    uint32_t sum[3];
+    primeWindow(in, pixelStride, length, radius, sum);
+    const auto at = [in, pixelStride, length](int32_t i) {
+        return in + static_cast<size_t>(std::clamp(i, 0, length - 1)) * pixelStride;
+    };
+    for (int32_t x = 0; x < length; x++) {
+        uint8_t* p = out + static_cast<size_t>(x) * pixelStride;
+        for (int32_t c = 0; c < 3; c++) p[c] = divide(sum[c]);
+        p[3] = 0xff;
+
+        // Slide the window by one pixel.
+        const uint8_t* incoming = at(x + radius + 1);
+        const uint8_t* outgoing = at(x - radius);
+        for (int32_t c = 0; c < 3; c++) sum[c] = sum[c] + incoming[c] - outgoing[c];
+    }
+}
+
+// Blur the columns of src into dst with a box filter. The windows of all the columns slide at
+// once, so that both src and dst are accessed row by row.
+void boxBlurColumns(const BitmapView& src, const BitmapView& dst, int32_t radius) {
+    const BoxDivider divide(radius);
+    const auto height = static_cast<int32_t>(src.height);
+    const size_t rowSize = src.width * 4;
+    std::vector<uint32_t> sums(rowSize);
+    for (uint32_t x = 0; x < src.width; x++) {
+        primeWindow(src.pixel(x, 0), src.stride, height, radius, &sums[x * 4]);
+    }
+    const auto rowAt = [&src, height](int32_t y) {
+        return src.row(static_cast<uint32_t>(std::clamp(y, 0, height - 1)));
+    };
+    for (int32_t y = 0; y < height; y++) {
+        uint8_t* out = dst.row(static_cast<uint32_t>(y));
+        const uint8_t* incoming = rowAt(y + radius + 1);
+        const uint8_t* outgoing = rowAt(y - radius);
+        for (size_t i = 0; i < rowSize; i += 4) {
+            for (size_t c = 0; c < 3; c++) {
+                out[i + c] = divide(sums[i + c]);
+                sums[i + c] = sums[i + c] + incoming[i + c] - outgoing[i + c];
+            }
+            out[i + 3] = 0xff;
+        }
+    }
+}
+
+// Return the view of the columns [xBegin, xEnd) of the bitmap.
+BitmapView getColumns(const BitmapView& view, uint32_t xBegin, uint32_t xEnd) {
+    return {view.pixels + size_t{xBegin} * 4, xEnd - xBegin, view.height, view.stride};
+}
+
+}  // namespace
+
+std::array<int32_t, kNumStackedBoxes> computeStackedBoxRadii(float sigma) {
+    // Choose the box widths such that the variance of the stacked boxes matches sigma^2, as in
+    // "Fast Almost-Gaussian Filtering" (Kovesi, 2010). The boxes have either width wl or wl + 2,
+    // where wl is the largest odd width not larger than the ideal one.
+    constexpr float n = static_cast<float>(kNumStackedBoxes);
+    const float variance = sigma * sigma;
+    const float idealWidth = std::sqrt(12.0f * variance / n + 1.0f);
+    int32_t wl = static_cast<int32_t>(std::floor(idealWidth));
+    if (wl % 2 == 0) wl--;
+    const auto fwl = static_cast<float>(wl);
+    const float idealNumSmall =
+            (12.0f * variance - n * fwl * fwl - 4.0f * n * fwl - 3.0f * n) / (-4.0f * fwl - 4.0f);
+    const auto numSmall = static_cast<int32_t>(std::lround(idealNumSmall));
+
+    std::array<int32_t, kNumStackedBoxes> radii;
+    for (uint32_t i = 0; i < kNumStackedBoxes; i++) {
+        const int32_t width = static_cast<int32_t>(i) < numSmall ? wl : wl + 2;
+        radii[i] = std::max(0, (width - 1) / 2);
+    }
+    return radii;
+}
+
+void boxBlurHorizontal(const BitmapView& src, const BitmapView& dst, const int32_t* radii,
+                       uint32_t numBoxes, const Tile& tile) {
+    // The boxes before the last one ping-pong between two line buffers.
+    const auto width = static_cast<int32_t>(src.width);
+    const size_t rowSize = size_t{src.width} * 4;
+    std::vector<uint8_t> lines(rowSize * 2);
+    uint8_t* const pingPong[] = {lines.data(), lines.data() + rowSize};
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        const uint8_t* in = src.row(y);
+        for (uint32_t i = 0; i < numBoxes; i++) {
+            uint8_t* out = i + 1 == numBoxes ? dst.row(y) : pingPong[i % 2];
+            boxBlurLine(in, out, 4, width, radii[i]);
+            in = out;
+        }
+    }
+}
+
+void boxBlurVertical(const BitmapView& src, const BitmapView& dst, const int32_t* radii,
+                     uint32_t numBoxes, const Tile& tile) {
+    // The boxes alternate between writing to dst and writing back to src. An even number of boxes
+    // ends in src, which is then copied to dst.
+    const BitmapView srcColumns = getColumns(src, tile.xBegin, tile.xEnd);
+    const BitmapView dstColumns = getColumns(dst, tile.xBegin, tile.xEnd);
+    for (uint32_t i = 0; i < numBoxes; i++) {
+        if (i % 2 == 0) {
+            boxBlurColumns(srcColumns, dstColumns, radii[i]);
+        } else {
+            boxBlurColumns(dstColumns, srcColumns, radii[i]);
+        }
+    }
+    if (numBoxes % 2 == 0) {
+        for (uint32_t y = 0; y < src.height; y++) {
+            memcpy(dstColumns.row(y), srcColumns.row(y), size_t{dstColumns.width} * 4);
+        }
+    }
+}
+
+}  // namespace cpu
+}  // namespace sample
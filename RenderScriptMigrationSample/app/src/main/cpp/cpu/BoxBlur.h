@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BOX_BLUR_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BOX_BLUR_H
+
+#include <array>
+#include <cstdint>
+
+#include "Bitmap.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// The maximum radius of the box blurs, the same as the box blurs of sample::ImageProcessor.
+constexpr float kMaxBoxBlurRadius = 500.0f;
+
+// The number of box filters applied by the stacked box blur. Three iterations of a box filter is
+// visually very close to a gaussian.
+constexpr uint32_t kNumStackedBoxes = 3;
+
+// Compute the radii of kNumStackedBoxes box filters, such that applying them one after another
+// approximates a gaussian filter with the given standard deviation.
+std::array<int32_t, kNumStackedBoxes> computeStackedBoxRadii(float sigma);
+
+// The grain sizes of the passes. The horizontal pass runs on whole rows, and the vertical pass on
+// whole columns, grouped so that a tile reads whole cache lines of each row.
+constexpr TileSize kBoxBlurHorizontalGrain = {0, 16};
+constexpr TileSize kBoxBlurVerticalGrain = {64, 0};
+
+// Apply numBoxes box filters of the given radii one after another with a sliding window,
+// clamping to edge, horizontally from src to the tile of dst, or vertically from the tile of src
+// to the tile of dst. The tiles must span whole rows and whole columns respectively. The cost per
+// pixel is independent of the radii. The src and dst bitmaps must have the same size, and must
+// not overlap. The alpha channel of dst is set to 255.
+//
+// Each box rounds its results to 8 bits, like the passes of sample::ImageProcessor::boxBlur. The
+// vertical pass ping-pongs between dst and src, so the tile of src is overwritten if numBoxes is
+// more than 1.
+void boxBlurHorizontal(const BitmapView& src, const BitmapView& dst, const int32_t* radii,
+                       uint32_t numBoxes, const Tile& tile);
+void boxBlurVertical(const BitmapView& src, const BitmapView& dst, const int32_t* radii,
+                     uint32_t numBoxes, const Tile& tile);
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_BOX_BLUR_H
@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ColorMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace sample {
+namespace cpu {
+namespace {
+
+constexpr int32_t kFractionBits = 12;
+constexpr int32_t kRounding = 1 << (kFractionBits - 1);
+
+// The fixed point of the lookup tables. The rounding is added to the table of the first channel.
+constexpr int32_t kLutFractionBits = 16;
+constexpr int32_t kLutRounding = 1 << (kLutFractionBits - 1);
+
+// Apply the Q12 color matrix to width pixels. All the SIMD kernels compute the same sum in 32-bit
+// integers, add kRounding, shift right by kFractionBits, and saturate to [0, 255].
+void colorMatrixQ12Scalar(const uint8_t* in, uint8_t* out, uint32_t width,
+                         const ColorMatrixQ12& m) {
+    for (uint32_t x = 0; x < width; x++, in += 4, out += 4) {
+        for (size_t c = 0; c < 3; c++) {
+            const int32_t sum = m[0][c] * in[0] + m[1][c] * in[1] + m[2][c] * in[2];
+            out[c] = static_cast<uint8_t>(std::clamp((sum + kRounding) >> kFractionBits, 0, 255));
+        }
+        out[3] = 0xff;
+    }
+}
+
+// Apply the lookup tables to width pixels. All the SIMD kernels compute the same sums, shift them
+// right by kLutFractionBits, and saturate to [0, 255].
+void colorMatrixLutScalar(const uint8_t* in, uint8_t* out, uint32_t width,
+                          const ColorMatrixLut& lut) {
+    for (uint32_t x = 0; x < width; x++, in += 4, out += 4) {
+        const int32_t* r = lut.entry(0, in[0]);
+        const int32_t* g = lut.entry(1, in[1]);
+        const int32_t* b = lut.entry(2, in[2]);
+        for (size_t c = 0; c < 4; c++) {
+            const int32_t sum = r[c] + g[c] + b[c];
+            out[c] = static_cast<uint8_t>(std::clamp(sum >> kLutFractionBits, 0, 255));
+        }
+    }
+}
+
+#if defined(__ARM_NEON)
+
+// Compute one output channel of 4 pixels, widened to 16 bits, with rounding and saturation to
+// 16 bits.
+uint16x4_t dotQ12(int16x4_t r, int16x4_t g, int16x4_t b, int16_t mr, int16_t mg, int16_t mb) {
+    int32x4_t sum = vmull_n_s16(r, mr);
+    sum = vmlal_n_s16(sum, g, mg);
+    sum = vmlal_n_s16(sum, b, mb);
+    return vqrshrun_n_s32(sum, kFractionBits);
+}
+
+// Process 16 pixels per iteration, deinterleaved into channel planes by vld4.
+void colorMatrixQ12Neon(const uint8_t* in, uint8_t* out, uint32_t width, const ColorMatrixQ12& m) {
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t pixels = vld4q_u8(in + x * 4);
+        int16x8_t channels[3][2];
+        for (size_t c = 0; c < 3; c++) {
+            channels[c][0] = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(pixels.val[c])));
+            channels[c][1] = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(pixels.val[c])));
+        }
+        uint8x16x4_t results;
+        for (size_t c = 0; c < 3; c++) {
+            uint16x8_t halves[2];
+            for (size_t h = 0; h < 2; h++) {
+                const int16x8_t& r = channels[0][h];
+                const int16x8_t& g = channels[1][h];
+                const int16x8_t& b = channels[2][h];
+                halves[h] = vcombine_u16(
+                        dotQ12(vget_low_s16(r), vget_low_s16(g), vget_low_s16(b), m[0][c], m[1][c],
+                              m[2][c]),
+                        dotQ12(vget_high_s16(r), vget_high_s16(g), vget_high_s16(b), m[0][c],
+                              m[1][c], m[2][c]));
+            }
+            results.val[c] = vcombine_u8(vqmovn_u16(halves[0]), vqmovn_u16(halves[1]));
+        }
+        results.val[3] = vdupq_n_u8(0xff);
+        vst4q_u8(out + x * 4, results);
+    }
+    colorMatrixQ12Scalar(in + x * 4, out + x * 4, width - x, m);
+}
+
+// Sum the entries of a pixel, with the channels in the lanes.
+int32x4_t sumLutEntries(const uint8_t* pixel, const ColorMatrixLut& lut) {
+    const int32x4_t sum = vaddq_s32(vld1q_s32(lut.entry(0, pixel[0])),
+                                    vld1q_s32(lut.entry(1, pixel[1])));
+    return vshrq_n_s32(vaddq_s32(sum, vld1q_s32(lut.entry(2, pixel[2]))), kLutFractionBits);
+}
+
+// NEON has no gather of 32-bit elements, and its table lookups index at most 64 bytes, so the
+// entries are loaded one by one. Process 4 pixels per iteration.
+void colorMatrixLutNeon(const uint8_t* in, uint8_t* out, uint32_t width,
+                        const ColorMatrixLut& lut) {
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const uint8_t* p = in + x * 4;
+        const uint16x8_t lo = vcombine_u16(vqmovun_s32(sumLutEntries(p, lut)),
+                                           vqmovun_s32(sumLutEntries(p + 4, lut)));
+        const uint16x8_t hi = vcombine_u16(vqmovun_s32(sumLutEntries(p + 8, lut)),
+                                           vqmovun_s32(sumLutEntries(p + 12, lut)));
+        vst1q_u8(out + x * 4, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+    }
+    colorMatrixLutScalar(in + x * 4, out + x * 4, width - x, lut);
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+// The x86 kernels process the pixels as interleaved RGBA. The pixels are widened to 16 bits, and
+// each output channel is a multiply-add of the (R, G) and (B, A) pairs with the coefficients
+// (mr, mg, mb, 0), followed by a horizontal add of the two halves. All the instructions operate
+// within 128-bit lanes, so the AVX2 kernel is the SSSE3 kernel with two lanes.
+
+__attribute__((target("ssse3"))) __m128i dotQ12Ssse3(__m128i lo, __m128i hi,
+                                                    __m128i coefficients) {
+    const __m128i sum = _mm_hadd_epi32(_mm_madd_epi16(lo, coefficients),
+                                       _mm_madd_epi16(hi, coefficients));
+    return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(kRounding)), kFractionBits);
+}
+
+// Process 4 pixels per vector, and 16 pixels per iteration.
+__attribute__((target("ssse3"))) void colorMatrixQ12Ssse3(const uint8_t* in, uint8_t* out,
+                                                         uint32_t width, const ColorMatrixQ12& m) {
+    __m128i coefficients[3];
+    for (size_t c = 0; c < 3; c++) {
+        coefficients[c] =
+                _mm_setr_epi16(m[0][c], m[1][c], m[2][c], 0, m[0][c], m[1][c], m[2][c], 0);
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32(0xff);
+    // Interleave the planar bytes R0-3, G0-3, B0-3, A0-3 back to 4 RGBA pixels.
+    const __m128i interleave =
+            _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        for (uint32_t i = 0; i < 16; i += 4) {
+            const __m128i pixels =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (x + i) * 4));
+            const __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            const __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            const __m128i rg = _mm_packs_epi32(dotQ12Ssse3(lo, hi, coefficients[0]),
+                                               dotQ12Ssse3(lo, hi, coefficients[1]));
+            const __m128i ba = _mm_packs_epi32(dotQ12Ssse3(lo, hi, coefficients[2]), alpha);
+            const __m128i planar = _mm_packus_epi16(rg, ba);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x + i) * 4),
+                             _mm_shuffle_epi8(planar, interleave));
+        }
+    }
+    colorMatrixQ12Scalar(in + x * 4, out + x * 4, width - x, m);
+}
+
+__attribute__((target("avx2"))) __m256i dotQ12Avx2(__m256i lo, __m256i hi,
+                                                  __m256i coefficients) {
+    const __m256i sum = _mm256_hadd_epi32(_mm256_madd_epi16(lo, coefficients),
+                                          _mm256_madd_epi16(hi, coefficients));
+    return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(kRounding)), kFractionBits);
+}
+
+// Process 8 pixels per vector, and 32 pixels per iteration.
+__attribute__((target("avx2"))) void colorMatrixQ12Avx2(const uint8_t* in, uint8_t* out,
+                                                       uint32_t width, const ColorMatrixQ12& m) {
+    __m256i coefficients[3];
+    for (size_t c = 0; c < 3; c++) {
+        const __m128i lane =
+                _mm_setr_epi16(m[0][c], m[1][c], m[2][c], 0, m[0][c], m[1][c], m[2][c], 0);
+        coefficients[c] = _mm256_broadcastsi128_si256(lane);
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32(0xff);
+    const __m256i interleave = _mm256_broadcastsi128_si256(
+            _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15));
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        for (uint32_t i = 0; i < 32; i += 8) {
+            const __m256i pixels =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (x + i) * 4));
+            const __m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+            const __m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+            const __m256i rg = _mm256_packs_epi32(dotQ12Avx2(lo, hi, coefficients[0]),
+                                                  dotQ12Avx2(lo, hi, coefficients[1]));
+            const __m256i ba = _mm256_packs_epi32(dotQ12Avx2(lo, hi, coefficients[2]), alpha);
+            const __m256i planar = _mm256_packus_epi16(rg, ba);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (x + i) * 4),
+                                _mm256_shuffle_epi8(planar, interleave));
+        }
+    }
+    colorMatrixQ12Ssse3(in + x * 4, out + x * 4, width - x, m);
+}
+
+// Sum the entries of a pixel, with the channels in the lanes. SSE2 is part of the x86 baseline.
+__m128i sumLutEntries(const uint8_t* pixel, const ColorMatrixLut& lut) {
+    const auto load = [&lut](size_t channel, uint8_t value) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(lut.entry(channel, value)));
+    };
+    const __m128i sum = _mm_add_epi32(_mm_add_epi32(load(0, pixel[0]), load(1, pixel[1])),
+                                      load(2, pixel[2]));
+    return _mm_srai_epi32(sum, kLutFractionBits);
+}
+
+// The AVX2 gathers load one 32-bit element per lane, so the 16-byte entries are loaded directly
+// instead. The sums of 4 pixels are packed to 16 bytes in RGBA order.
+void colorMatrixLutSse2(const uint8_t* in, uint8_t* out, uint32_t width,
+                        const ColorMatrixLut& lut) {
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const uint8_t* p = in + x * 4;
+        const __m128i lo = _mm_packs_epi32(sumLutEntries(p, lut), sumLutEntries(p + 4, lut));
+        const __m128i hi = _mm_packs_epi32(sumLutEntries(p + 8, lut), sumLutEntries(p + 12, lut));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(lo, hi));
+    }
+    colorMatrixLutScalar(in + x * 4, out + x * 4, width - x, lut);
+}
+
+#endif
+
+}  // namespace
+
+ColorMatrixLut::ColorMatrixLut(const ColorMatrix& matrix) {
+    constexpr auto scale = static_cast<float>(1 << kLutFractionBits);
+    for (size_t c = 0; c < 3; c++) {
+        for (int32_t v = 0; v < 256; v++) {
+            auto& lanes = mTables[c][static_cast<size_t>(v)].lanes;
+            for (size_t r = 0; r < 3; r++) {
+                lanes[r] = static_cast<int32_t>(
+                        std::lround(matrix[c][r] * static_cast<float>(v) * scale));
+            }
+            lanes[3] = 0;
+        }
+    }
+    for (auto& entry : mTables[0]) {
+        for (size_t r = 0; r < 3; r++) entry.lanes[r] += kLutRounding;
+        entry.lanes[3] = 255 << kLutFractionBits;
+    }
+}
+
+ColorMatrixQ12 quantizeColorMatrix(const ColorMatrix& matrix) {
+    ColorMatrixQ12 result;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            result[i][j] = static_cast<int16_t>(std::lround(matrix[i][j] * (1 << kFractionBits)));
+        }
+    }
+    return result;
+}
+
+ColorMatrix computeHueRotationMatrix(float radian) {
+    const float cos = std::cos(radian);
+    const float sin = std::sin(radian);
+    ColorMatrix matrix;
+    matrix[0][0] = 0.299f + 0.701f * cos + 0.168f * sin;
+    matrix[0][1] = 0.299f - 0.299f * cos - 0.328f * sin;
+    matrix[0][2] = 0.299f - 0.300f * cos + 1.250f * sin;
+    matrix[1][0] = 0.587f - 0.587f * cos + 0.330f * sin;
+    matrix[1][1] = 0.587f + 0.413f * cos + 0.035f * sin;
+    matrix[1][2] = 0.587f - 0.588f * cos - 1.050f * sin;
+    matrix[2][0] = 0.114f - 0.114f * cos - 0.497f * sin;
+    matrix[2][1] = 0.114f - 0.114f * cos + 0.292f * sin;
+    matrix[2][2] = 0.114f + 0.886f * cos - 0.203f * sin;
+    return matrix;
+}
+
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrix& matrix,
+                 const Tile& tile) {
+    forEachPixel(src, dst, ColorMatrixKernel(matrix), tile);
+}
+
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrixQ12& matrix,
+                 const Tile& tile, SimdLevel level) {
+    auto kernel = colorMatrixQ12Scalar;
+#if defined(__ARM_NEON)
+    if (level == SimdLevel::kNeon) kernel = colorMatrixQ12Neon;
+#elif defined(__x86_64__) || defined(__i386__)
+    if (level == SimdLevel::kSsse3) kernel = colorMatrixQ12Ssse3;
+    if (level == SimdLevel::kAvx2) kernel = colorMatrixQ12Avx2;
+#else
+    (void)level;
+#endif
+    const uint32_t width = tile.xEnd - tile.xBegin;
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        kernel(src.pixel(tile.xBegin, y), dst.pixel(tile.xBegin, y), width, matrix);
+    }
+}
+
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrixLut& lut,
+                 const Tile& tile, SimdLevel level) {
+    auto kernel = colorMatrixLutScalar;
+#if defined(__ARM_NEON)
+    if (level == SimdLevel::kNeon) kernel = colorMatrixLutNeon;
+#elif defined(__x86_64__) || defined(__i386__)
+    if (level != SimdLevel::kScalar) kernel = colorMatrixLutSse2;
+#else
+    (void)level;
+#endif
+    const uint32_t width = tile.xEnd - tile.xBegin;
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        kernel(src.pixel(tile.xBegin, y), dst.pixel(tile.xBegin, y), width, lut);
+    }
+}
+
+}  // namespace cpu
+}  // namespace sample
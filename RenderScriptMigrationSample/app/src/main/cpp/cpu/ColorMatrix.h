@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_COLOR_MATRIX_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_COLOR_MATRIX_H
+
+#include <array>
+#include <cstdint>
+
+#include "Bitmap.h"
+#include "CpuFeatures.h"
+#include "PixelKernel.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// A 3x3 matrix applied to the RGB channels, stored column by column like the GLSL mat3 of the
+// ColorMatrix shader, i.e. output channel r is the sum of matrix[c][r] * input channel c.
+using ColorMatrix = std::array<std::array<float, 3>, 3>;
+
+// A color matrix with the coefficients in Q12 fixed point, i.e. scaled by 4096 and rounded, in
+// the same layout as ColorMatrix. The integer path of ScriptIntrinsicColorMatrix uses Q8, which is
+// off by up to 2 from the float results for the hue rotation matrices, Q12 keeps within 1.
+using ColorMatrixQ12 = std::array<std::array<int16_t, 3>, 3>;
+
+// Quantize the coefficients of the color matrix, which must be within (-8, 8).
+ColorMatrixQ12 quantizeColorMatrix(const ColorMatrix& matrix);
+
+// The color matrix decomposed into lookup tables for 8-bit inputs. The table of input channel c
+// maps each value v to the contributions matrix[c][r] * v to the output channels r, in Q16 fixed
+// point, so a pixel takes three lookups and two vector additions, and no multiplication. The
+// entries are 4 lanes wide to be added as vectors, and the 4th lanes hold the alpha of 255. The
+// tables take 12 KiB, so they stay in L1 cache.
+class ColorMatrixLut {
+   public:
+    explicit ColorMatrixLut(const ColorMatrix& matrix);
+
+    const int32_t* entry(size_t channel, uint8_t value) const {
+        return mTables[channel][value].lanes.data();
+    }
+
+   private:
+    struct alignas(16) Entry {
+        std::array<int32_t, 4> lanes;
+    };
+    std::array<std::array<Entry, 256>, 3> mTables;
+};
+
+// The ways to apply a color matrix to 8-bit images: multiplications by the Q12 coefficients,
+// additions of the entries of a ColorMatrixLut, or multiplications in float with the
+// ColorMatrixKernel, vectorized over the channels of each pixel regardless of the SimdLevel. The
+// float method is the reference of the other two, and is not meant to be fast.
+enum class ColorMatrixMethod {
+    kMultiply,
+    kLookupTable,
+    kFloat,
+};
+
+// Compute the color matrix of the hue rotation by radian, the combination of
+// RGB->HSV transform * HUE rotation * HSV->RGB transform.
+ColorMatrix computeHueRotationMatrix(float radian);
+
+// The color matrix as a pixel kernel, see PixelKernel.h. The alpha channel is set to 1.
+class ColorMatrixKernel {
+   public:
+    explicit ColorMatrixKernel(const ColorMatrix& matrix)
+        : mColumns{toFloat4(matrix[0]), toFloat4(matrix[1]), toFloat4(matrix[2])} {}
+
+    float4 operator()(float4 pixel) const {
+        return mColumns[0] * pixel[0] + mColumns[1] * pixel[1] + mColumns[2] * pixel[2] +
+               float4{0.0f, 0.0f, 0.0f, 1.0f};
+    }
+
+   private:
+    static float4 toFloat4(const std::array<float, 3>& column) {
+        return float4{column[0], column[1], column[2], 0.0f};
+    }
+
+    std::array<float4, 3> mColumns;
+};
+
+// Apply the color matrix to the tile of src, and write the results to the same tile of dst,
+// rounding to the nearest value and saturating. The src and dst bitmaps must have the same
+// size. The alpha channel of dst is set to 255.
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrix& matrix,
+                 const Tile& tile);
+
+// Same as above with the Q12 coefficients and integer arithmetic, vectorized for the SIMD level,
+// which must be supported, see isSimdLevelSupported. The results are the same at all levels, and
+// within 1 of the float version for the hue rotation matrices. The whole computation stays in
+// registers, so the throughput is bound by the memory bandwidth.
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrixQ12& matrix,
+                 const Tile& tile, SimdLevel level = getSimdLevel());
+
+// Same as above with the lookup tables, which are within 1 of the float version. The results are
+// the same at all levels.
+void colorMatrix(const BitmapView& src, const BitmapView& dst, const ColorMatrixLut& lut,
+                 const Tile& tile, SimdLevel level = getSimdLevel());
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_COLOR_MATRIX_H
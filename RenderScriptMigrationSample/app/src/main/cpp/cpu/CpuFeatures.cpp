@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CpuFeatures.h"
+
+namespace sample {
+namespace cpu {
+namespace {
+
+SimdLevel detectSimdLevel() {
+#if defined(__ARM_NEON)
+    return SimdLevel::kNeon;
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::kAvx2;
+    if (__builtin_cpu_supports("ssse3")) return SimdLevel::kSsse3;
+    return SimdLevel::kScalar;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+}  // namespace
+
+SimdLevel getSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::kScalar:
+            return true;
+        case SimdLevel::kNeon:
+            return getSimdLevel() == SimdLevel::kNeon;
+        case SimdLevel::kSsse3:
+            return getSimdLevel() == SimdLevel::kSsse3 || getSimdLevel() == SimdLevel::kAvx2;
+        case SimdLevel::kAvx2:
+            return getSimdLevel() == SimdLevel::kAvx2;
+    }
+    return false;
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::kScalar:
+            return "scalar";
+        case SimdLevel::kNeon:
+            return "neon";
+        case SimdLevel::kSsse3:
+            return "ssse3";
+        case SimdLevel::kAvx2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+}  // namespace cpu
+}  // namespace sample
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_CPU_FEATURES_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_CPU_FEATURES_H
+
+namespace sample {
+namespace cpu {
+
+// The SIMD instruction sets of the CPU kernels, from the least to the most capable on each
+// architecture.
+enum class SimdLevel {
+    kScalar,
+    // ARM Advanced SIMD, part of the armeabi-v7a and arm64-v8a ABIs.
+    kNeon,
+    // x86 Supplemental SSE3, part of the x86 and x86_64 ABIs, but not of the generic x86_64 host.
+    kSsse3,
+    kAvx2,
+};
+
+// Return the best SIMD level supported by both the build and the running CPU. The CPU is only
+// queried on the first call.
+SimdLevel getSimdLevel();
+
+// Return whether a kernel can run at the given level, i.e. the level is kScalar, or the kernels
+// of the level are built and the running CPU supports it.
+bool isSimdLevelSupported(SimdLevel level);
+
+const char* getSimdLevelName(SimdLevel level);
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_CPU_FEATURES_H
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GaussianBlur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sample {
+namespace cpu {
+namespace {
+
+// The size of the rolling buffer of a tile. Together with the line buffers, it should fit in the
+// L2 cache of a core, which is at least 256 KiB on the CPUs of recent devices.
+constexpr size_t kMaxRollingBufferBytes = 192 * 1024;
+
+// The minimum width of a tile. Narrower tiles would spend more time on the columns around them
+// needed by the horizontal pass than on their own columns.
+constexpr size_t kMinTileWidth = 64;
+
+// The minimum height of a tile in multiples of iRadius, to keep the work of the extra rows
+// blurred horizontally below a quarter of the total.
+constexpr uint32_t kMinTileHeightInRadii = 8;
+
+float4 loadPixel(const uint8_t* p) {
+    return float4{static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]),
+                  static_cast<float>(p[3])};
+}
+
+void storePixel(float4 value, uint8_t* p) {
+    for (size_t c = 0; c < 3; c++) p[c] = toUnorm8(value[c]);
+    p[3] = 0xff;
+}
+
+// Blur the pixels [x0, x0 + width) of row horizontally into out. The line buffer holds the
+// pixels [x0 - iRadius, x0 + width + iRadius) of row, clamped to edge and converted to float.
+void blurRowSegment(const BitmapView& src, uint32_t y, uint32_t x0, size_t width,
+                    const float* kernel, int32_t iRadius, float4* line, float4* out) {
+    const uint8_t* row = src.row(y);
+    const auto lastX = static_cast<int32_t>(src.width) - 1;
+    const size_t lineWidth = width + 2 * static_cast<size_t>(iRadius);
+    for (size_t i = 0; i < lineWidth; i++) {
+        const int32_t x = static_cast<int32_t>(x0 + i) - iRadius;
+        line[i] = loadPixel(row + static_cast<size_t>(std::clamp(x, 0, lastX)) * 4);
+    }
+    const size_t kernelSize = 2 * static_cast<size_t>(iRadius) + 1;
+    for (size_t i = 0; i < width; i++) {
+        float4 sum = {};
+        for (size_t k = 0; k < kernelSize; k++) sum += kernel[k] * line[i + k];
+        out[i] = sum;
+    }
+}
+
+}  // namespace
+
+int32_t computeGaussianKernel(float radius, float* kernel) {
+    constexpr float e = 2.718281828459045f;
+    constexpr float pi = 3.1415926535897932f;
+    float sigma = 0.4f * radius + 0.6f;
+    float coeff1 = 1.0f / (std::sqrt(2.0f * pi) * sigma);
+    float coeff2 = -1.0f / (2.0f * sigma * sigma);
+    int32_t iRadius = static_cast<int>(std::ceil(radius));
+    float normalizeFactor = 0.0f;
+    for (int r = -iRadius; r <= iRadius; r++) {
+        const float value = coeff1 * std::pow(e, coeff2 * static_cast<float>(r * r));
+        kernel[r + iRadius] = value;
+        normalizeFactor += value;
+    }
+    normalizeFactor = 1.0f / normalizeFactor;
+    for (int r = -iRadius; r <= iRadius; r++) {
+        kernel[r + iRadius] *= normalizeFactor;
+    }
+    return iRadius;
+}
+
+TileSize getGaussianBlurGrain(int32_t iRadius) {
+    const size_t kernelSize = 2 * static_cast<size_t>(iRadius) + 1;
+    const size_t width = std::max(kMaxRollingBufferBytes / (kernelSize * sizeof(float4)),
+                                  kMinTileWidth);
+    return {static_cast<uint32_t>(width), kMinTileHeightInRadii * static_cast<uint32_t>(iRadius)};
+}
+
+void gaussianBlur(const BitmapView& src, const BitmapView& dst, const float* kernel,
+                  int32_t iRadius, const Tile& tile, GaussianBlurScratch* scratch) {
+    const size_t kernelSize = 2 * static_cast<size_t>(iRadius) + 1;
+    const size_t width = tile.xEnd - tile.xBegin;
+    scratch->rollingBuffer.resize(std::max(scratch->rollingBuffer.size(), kernelSize * width));
+    scratch->line.resize(std::max(scratch->line.size(), width + kernelSize - 1));
+    scratch->sums.resize(std::max(scratch->sums.size(), width));
+    float4* sums = scratch->sums.data();
+
+    // The row y of the virtual image extended by clamping to edge is kept in the rolling buffer
+    // at slot (y - firstY) mod kernelSize, so the row blurred last replaces the row no longer
+    // needed.
+    const auto firstY = static_cast<int32_t>(tile.yBegin) - iRadius;
+    const auto lastY = static_cast<int32_t>(src.height) - 1;
+    const auto slot = [rollingBuffer = scratch->rollingBuffer.data(), kernelSize, width,
+                       firstY](int32_t y) {
+        return rollingBuffer + static_cast<size_t>(y - firstY) % kernelSize * width;
+    };
+    const auto blurRow = [&](int32_t y) {
+        blurRowSegment(src, static_cast<uint32_t>(std::clamp(y, 0, lastY)), tile.xBegin, width,
+                       kernel, iRadius, scratch->line.data(), slot(y));
+    };
+
+    // Prime the rolling buffer with the rows above the first output row.
+    for (int32_t y = firstY; y < static_cast<int32_t>(tile.yBegin) + iRadius; y++) blurRow(y);
+
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        const auto iy = static_cast<int32_t>(y);
+        blurRow(iy + iRadius);
+
+        // Accumulate the rows of the rolling buffer weighted by the kernel, across the whole tile
+        // at once.
+        std::fill(sums, sums + width, float4{});
+        for (size_t k = 0; k < kernelSize; k++) {
+            const float4* row = slot(iy - iRadius + static_cast<int32_t>(k));
+            const float weight = kernel[k];
+            for (size_t i = 0; i < width; i++) sums[i] += weight * row[i];
+        }
+        uint8_t* out = dst.pixel(tile.xBegin, y);
+        for (size_t i = 0; i < width; i++) storePixel(sums[i], out + i * 4);
+    }
+}
+
+}  // namespace cpu
+}  // namespace sample
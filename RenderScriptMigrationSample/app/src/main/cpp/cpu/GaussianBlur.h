@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_GAUSSIAN_BLUR_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_GAUSSIAN_BLUR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitmap.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// The maximum radius of the gaussian blur, and the maximum number of kernel weights.
+constexpr float kMaxGaussianRadius = 25.0f;
+constexpr uint32_t kMaxGaussianKernelSize = 2 * 25 + 1;
+
+// Calculate the gaussian kernel of the given radius into kernel, which must hold
+// kMaxGaussianKernelSize elements, and return the integer radius. The kernel has a standard
+// deviation of 0.4 * radius + 0.6, and 2 * iRadius + 1 weights summing up to 1.
+// This is equivalent to ComputeGaussianWeights at
+// https://cs.android.com/android/platform/superproject/+/master:frameworks/rs/cpu_ref/rsCpuIntrinsicBlur.cpp;l=57
+int32_t computeGaussianKernel(float radius, float* kernel);
+
+// The scratch memory of gaussianBlur, which can be reused across the calls on the same thread.
+struct GaussianBlurScratch {
+    std::vector<float4> rollingBuffer;
+    std::vector<float4> line;
+    std::vector<float4> sums;
+};
+
+// Return the grain size of gaussianBlur for the integer radius. The tiles are narrow enough for
+// the rolling buffer to fit in L2 cache, and much taller than iRadius, see gaussianBlur.
+TileSize getGaussianBlurGrain(int32_t iRadius);
+
+// Apply the separable gaussian blur with the kernel of computeGaussianKernel to the tile of dst,
+// clamping to edge. The src and dst bitmaps must have the same size, and must not overlap. The
+// alpha channel of dst is set to 255.
+//
+// The rows of the tile are blurred horizontally one at a time into a rolling buffer of the
+// 2 * iRadius + 1 rows needed by the vertical pass, which accumulates whole rows of the buffer at
+// once. So both passes read the source once, and the intermediate results never leave the cache.
+// The iRadius rows above and below the tile are blurred horizontally too, so the tiles should be
+// much taller than iRadius.
+void gaussianBlur(const BitmapView& src, const BitmapView& dst, const float* kernel,
+                  int32_t iRadius, const Tile& tile, GaussianBlurScratch* scratch);
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_GAUSSIAN_BLUR_H
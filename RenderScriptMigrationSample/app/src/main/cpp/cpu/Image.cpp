@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Image.h"
+
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace sample {
+namespace cpu {
+namespace {
+
+// The smallest size class. Smaller images are rare, and not worth more classes.
+constexpr size_t kMinSizeClass = 4096;
+
+// The number of size classes per power of two.
+constexpr size_t kSizeClassesPerPowerOfTwo = 4;
+
+}  // namespace
+
+size_t ImagePool::getSizeClass(size_t size) {
+    if (size <= kMinSizeClass) return kMinSizeClass;
+    size_t powerOfTwo = kMinSizeClass;
+    while (powerOfTwo * 2 < size) powerOfTwo *= 2;
+    const size_t step = powerOfTwo / kSizeClassesPerPowerOfTwo;
+    return (size + step - 1) / step * step;
+}
+
+void* ImagePool::allocateBlock(size_t blockSize) const {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (mUseHugePages && blockSize >= kHugePageSize) {
+        // A huge page must be aligned to its size, which mmap does not guarantee. Map enough to
+        // align the block, and unmap the unused head and tail, so the block is one mapping that
+        // freeBlock unmaps.
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t mappedBlockSize = (blockSize + pageSize - 1) / pageSize * pageSize;
+        const size_t mappingSize = mappedBlockSize + kHugePageSize;
+        void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) return nullptr;
+        const auto begin = reinterpret_cast<uintptr_t>(mapping);
+        const uintptr_t block = (begin + kHugePageSize - 1) & ~uintptr_t{kHugePageSize - 1};
+        const size_t headSize = block - begin;
+        if (headSize > 0) munmap(mapping, headSize);
+        const size_t tailSize = mappingSize - headSize - mappedBlockSize;
+        if (tailSize > 0) munmap(reinterpret_cast<void*>(block + mappedBlockSize), tailSize);
+        // Only a hint, the kernel may not support transparent huge pages or have none free.
+        madvise(reinterpret_cast<void*>(block), blockSize, MADV_HUGEPAGE);
+        return reinterpret_cast<void*>(block);
+    }
+#endif
+    return ::operator new(blockSize, std::align_val_t{kImageRowAlignment}, std::nothrow);
+}
+
+void ImagePool::freeBlock(void* block, size_t blockSize) const {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (mUseHugePages && blockSize >= kHugePageSize) {
+        munmap(block, blockSize);
+        return;
+    }
+#endif
+    ::operator delete(block, std::align_val_t{kImageRowAlignment});
+}
+
+void* ImagePool::acquire(size_t size, size_t* blockSize) {
+    *blockSize = getSizeClass(size);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mCachedBlocks.find(*blockSize);
+        if (it != mCachedBlocks.end() && !it->second.empty()) {
+            void* block = it->second.back();
+            it->second.pop_back();
+            mCachedBytes -= *blockSize;
+            return block;
+        }
+    }
+    return allocateBlock(*blockSize);
+}
+
+void ImagePool::release(void* block, size_t blockSize) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mCachedBytes + blockSize <= mMaxCachedBytes) {
+            mCachedBlocks[blockSize].push_back(block);
+            mCachedBytes += blockSize;
+            return;
+        }
+    }
+    freeBlock(block, blockSize);
+}
+
+void ImagePool::releaseCachedMemory() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& [blockSize, blocks] : mCachedBlocks) {
+        for (void* block : blocks) freeBlock(block, blockSize);
+    }
+    mCachedBlocks.clear();
+    mCachedBytes = 0;
+}
+
+size_t ImagePool::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCachedBytes;
+}
+
+std::unique_ptr<Image> Image::create(uint32_t width, uint32_t height, ImagePool* pool) {
+    auto image = std::make_unique<Image>(pool);
+    if (!image->allocate(width, height)) return nullptr;
+    return image;
+}
+
+Image::~Image() {
+    if (mBlock != nullptr) mPool->release(mBlock, mBlockSize);
+}
+
+size_t Image::getStride(uint32_t width) {
+    constexpr size_t kPageSize = 4096;
+    size_t stride = (size_t{width} * 4 + kImageRowAlignment - 1) / kImageRowAlignment *
+                    kImageRowAlignment;
+    if (stride % kPageSize == 0) stride += kImageRowAlignment;
+    return stride;
+}
+
+bool Image::allocate(uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) return false;
+    const size_t stride = getStride(width);
+    mBlock = mPool->acquire(stride * height, &mBlockSize);
+    if (mBlock == nullptr) return false;
+    mView = {static_cast<uint8_t*>(mBlock), width, height, stride};
+    return true;
+}
+
+}  // namespace cpu
+}  // namespace sample
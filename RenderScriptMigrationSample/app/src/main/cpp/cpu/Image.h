@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Bitmap.h"
+
+namespace sample {
+namespace cpu {
+
+// The alignment of the image rows, a cache line on the CPUs of all ABIs and the widest SIMD load.
+constexpr size_t kImageRowAlignment = 64;
+
+// ImagePool caches the memory of released images by size class, the native counterpart of the
+// scratch allocations RenderScript reused across launches, e.g. gScratch1 and gScratch2 of
+// blur.rs. So reconfiguring the processor for another image of the same size reuses the memory
+// of the previous images instead of going back to the system allocator.
+//
+// The sizes are rounded up to size classes with four classes per power of two, so that images of
+// slightly different sizes share blocks, wasting at most a quarter of a block. Blocks of at least
+// kHugePageSize are mapped directly, aligned to kHugePageSize, and advised to be backed by
+// transparent huge pages where supported, which reduces the TLB misses of the vertical passes over
+// large images.
+//
+// The pool is thread-safe, and must outlive the images allocated from it.
+class ImagePool {
+   public:
+    // The size of a huge page on the ABIs supporting them.
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    // Create a pool keeping up to maxCachedBytes of released memory. Huge pages are only used if
+    // useHugePages is true.
+    explicit ImagePool(size_t maxCachedBytes = 64 * 1024 * 1024, bool useHugePages = true)
+        : mMaxCachedBytes(maxCachedBytes), mUseHugePages(useHugePages) {}
+    ~ImagePool() { releaseCachedMemory(); }
+
+    // Non-copyable
+    ImagePool(const ImagePool&) = delete;
+    ImagePool& operator=(const ImagePool&) = delete;
+
+    // Return a block of at least size bytes aligned to kImageRowAlignment, reusing a cached block
+    // of the same size class if any, and the size of the block in blockSize. Return nullptr if
+    // failed.
+    void* acquire(size_t size, size_t* blockSize);
+
+    // Return a block of acquire to the pool. The block is cached unless the cache is full.
+    void release(void* block, size_t blockSize);
+
+    // Free all the cached blocks.
+    void releaseCachedMemory();
+
+    size_t cachedBytes() const;
+
+    // Return the size class of the size, i.e. the size of the blocks allocated for it.
+    static size_t getSizeClass(size_t size);
+
+   private:
+    void* allocateBlock(size_t blockSize) const;
+    void freeBlock(void* block, size_t blockSize) const;
+
+    const size_t mMaxCachedBytes;
+    const bool mUseHugePages;
+
+    mutable std::mutex mMutex;
+    std::map<size_t, std::vector<void*>> mCachedBlocks;
+    size_t mCachedBytes = 0;
+};
+
+// An RGBA_8888 image in host memory from an ImagePool. The rows start at kImageRowAlignment
+// aligned addresses, and the stride is padded accordingly, so the SIMD kernels never split a
+// cache line at the start of a row. The memory returns to the pool when the image is destroyed.
+class Image {
+   public:
+    // Allocate an image of width x height from the pool. Return nullptr if failed.
+    static std::unique_ptr<Image> create(uint32_t width, uint32_t height, ImagePool* pool);
+
+    // Prefer Image::create
+    explicit Image(ImagePool* pool) : mPool(pool) {}
+    ~Image();
+
+    // Non-copyable
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    const BitmapView& view() const { return mView; }
+    uint32_t width() const { return mView.width; }
+    uint32_t height() const { return mView.height; }
+    size_t stride() const { return mView.stride; }
+
+    // Return the stride of the rows of an image of the given width: the row size padded to
+    // kImageRowAlignment, plus one more cache line if that is a multiple of 4 KiB, so that the
+    // pixels of a column do not all map to the same cache set.
+    static size_t getStride(uint32_t width);
+
+   private:
+    bool allocate(uint32_t width, uint32_t height);
+
+    ImagePool* mPool;
+    void* mBlock = nullptr;
+    size_t mBlockSize = 0;
+    BitmapView mView;
+};
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_H
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ImageProcessor.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "BoxBlur.h"
+#include "ColorMatrix.h"
+#include "GaussianBlur.h"
+#include "Lut.h"
+#include "RecursiveGaussian.h"
+#include "Saturation.h"
+
+namespace sample {
+namespace cpu {
+
+std::unique_ptr<ImageProcessor> ImageProcessor::create(uint32_t numThreads,
+                                                       SimdLevel simdLevel) {
+    if (!isSimdLevelSupported(simdLevel)) return nullptr;
+    return std::make_unique<ImageProcessor>(numThreads, simdLevel);
+}
+
+bool ImageProcessor::configureInputAndOutput(const BitmapView& input, int numberOfOutputImages) {
+    if (input.pixels == nullptr || input.width == 0 || input.height == 0) return false;
+    if (numberOfOutputImages <= 0) return false;
+
+    // Return the previous images to the pool first, so that they are reused for an input of the
+    // same size.
+    mInputImage = nullptr;
+    mOutputImages.clear();
+
+    auto inputImage = Image::create(input.width, input.height, &mImagePool);
+    if (inputImage == nullptr) return false;
+    const size_t rowSize = size_t{input.width} * 4;
+    for (uint32_t y = 0; y < input.height; y++) {
+        memcpy(inputImage->view().row(y), input.row(y), rowSize);
+    }
+    std::vector<std::unique_ptr<Image>> outputImages(static_cast<size_t>(numberOfOutputImages));
+    for (auto& image : outputImages) {
+        image = Image::create(input.width, input.height, &mImagePool);
+        if (image == nullptr) return false;
+    }
+    mInputImage = std::move(inputImage);
+    mOutputImages = std::move(outputImages);
+    return true;
+}
+
+BitmapView ImageProcessor::getOutputImage(int index) const {
+    if (!isValidOutputIndex(index)) return {};
+    return mOutputImages[static_cast<size_t>(index)]->view();
+}
+
+bool ImageProcessor::rotateHue(float radian, int outputIndex) {
+    return rotateHue(radian, outputIndex, ColorMatrixMethod::kMultiply);
+}
+
+bool ImageProcessor::rotateHue(float radian, int outputIndex, ColorMatrixMethod method) {
+    if (!isValidOutputIndex(outputIndex)) return false;
+    const BitmapView& src = mInputImage->view();
+    const BitmapView& dst = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+    if (method == ColorMatrixMethod::kFloat) {
+        const ColorMatrix matrix = computeHueRotationMatrix(radian);
+        forEachTile(&mThreadPool, src.width, src.height, kPixelKernelGrain,
+                    [&src, &dst, &matrix](const Tile& tile, uint32_t) {
+                        colorMatrix(src, dst, matrix, tile);
+                    });
+        return true;
+    }
+    if (method == ColorMatrixMethod::kLookupTable) {
+        const ColorMatrixLut lut(computeHueRotationMatrix(radian));
+        forEachTile(&mThreadPool, src.width, src.height, kPixelKernelGrain,
+                    [this, &src, &dst, &lut](const Tile& tile, uint32_t) {
+                        colorMatrix(src, dst, lut, tile, mSimdLevel);
+                    });
+        return true;
+    }
+    const ColorMatrixQ12 matrix = quantizeColorMatrix(computeHueRotationMatrix(radian));
+    forEachTile(&mThreadPool, src.width, src.height, kPixelKernelGrain,
+                [this, &src, &dst, &matrix](const Tile& tile, uint32_t) {
+                    colorMatrix(src, dst, matrix, tile, mSimdLevel);
+                });
+    return true;
+}
+
+bool ImageProcessor::saturation(float saturation, int outputIndex) {
+    if (!isValidOutputIndex(outputIndex)) return false;
+    const BitmapView& src = mInputImage->view();
+    const BitmapView& dst = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+    forEachTile(&mThreadPool, src.width, src.height, kPixelKernelGrain,
+                [this, &src, &dst, saturation](const Tile& tile, uint32_t) {
+                    cpu::saturation(src, dst, saturation, tile, mSimdLevel);
+                });
+    return true;
+}
+
+bool ImageProcessor::adjustColors(float radian, float saturation, const uint8_t* red,
+                                  const uint8_t* green, const uint8_t* blue, const uint8_t* alpha,
+                                  int outputIndex) {
+    if (red == nullptr || green == nullptr || blue == nullptr || alpha == nullptr) return false;
+    const auto kernel = fuseKernels(ColorMatrixKernel(computeHueRotationMatrix(radian)),
+                                    SaturationKernel(saturation),
+                                    LutKernel(red, green, blue, alpha));
+    return applyPixelKernel(kernel, outputIndex);
+}
+
+bool ImageProcessor::blur(float radius, int outputIndex) {
+    if (!isValidOutputIndex(outputIndex)) return false;
+    if (radius < 1.0f || radius > kMaxGaussianRadius) return false;
+    float kernel[kMaxGaussianKernelSize];
+    const int32_t iRadius = computeGaussianKernel(radius, kernel);
+
+    // Each tile runs both passes, in the scratch memory of the thread running it.
+    const BitmapView& src = mInputImage->view();
+    const BitmapView& dst = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+    forEachTile(&mThreadPool, src.width, src.height, getGaussianBlurGrain(iRadius),
+                [this, &src, &dst, &kernel, iRadius](const Tile& tile, uint32_t thread) {
+                    gaussianBlur(src, dst, kernel, iRadius, tile, &mBlurScratch[thread]);
+                });
+    return true;
+}
+
+bool ImageProcessor::recursiveBlur(float radius, int outputIndex) {
+    if (!isValidOutputIndex(outputIndex)) return false;
+    if (radius < 1.0f || radius > kMaxRecursiveGaussianRadius) return false;
+    // Use the same standard deviation as the gaussian kernel of blur.
+    const RecursiveGaussianCoefficients coefficients =
+            computeRecursiveGaussianCoefficients(0.4f * radius + 0.6f);
+
+    // The horizontal pass writes to the output image, which the vertical pass then filters in
+    // place.
+    const BitmapView& src = mInputImage->view();
+    const BitmapView& dst = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+    forEachTile(&mThreadPool, src.width, src.height,
+                getRecursiveGaussianHorizontalGrain(src.width),
+                [this, &src, &dst, &coefficients](const Tile& tile, uint32_t thread) {
+                    recursiveGaussianHorizontal(src, dst, coefficients, tile,
+                                                &mRecursiveBlurScratch[thread]);
+                });
+    forEachTile(&mThreadPool, dst.width, dst.height, getRecursiveGaussianVerticalGrain(dst.height),
+                [this, &dst, &coefficients](const Tile& tile, uint32_t thread) {
+                    recursiveGaussianVertical(dst, coefficients, tile,
+                                              &mRecursiveBlurScratch[thread]);
+                });
+    return true;
+}
+
+bool ImageProcessor::boxBlur(float radius, int outputIndex) {
+    if (radius < 1.0f || radius > kMaxBoxBlurRadius) return false;
+    const int32_t radii[] = {static_cast<int32_t>(std::ceil(radius))};
+    return applyBoxBlurs(radii, 1, outputIndex);
+}
+
+bool ImageProcessor::stackedBoxBlur(float radius, int outputIndex) {
+    if (radius < 1.0f || radius > kMaxBoxBlurRadius) return false;
+    // Use the same standard deviation as the gaussian kernel of blur.
+    const auto radii = computeStackedBoxRadii(0.4f * radius + 0.6f);
+    return applyBoxBlurs(radii.data(), kNumStackedBoxes, outputIndex);
+}
+
+bool ImageProcessor::applyBoxBlurs(const int32_t* radii, uint32_t numBoxes, int outputIndex) {
+    if (!isValidOutputIndex(outputIndex)) return false;
+    const BitmapView& src = mInputImage->view();
+    const BitmapView& dst = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+    const auto intermediateImage = Image::create(src.width, src.height, &mImagePool);
+    if (intermediateImage == nullptr) return false;
+
+    // The vertical pass needs whole columns of the horizontal pass, so the passes run one after
+    // another, each split into tiles.
+    const BitmapView& intermediate = intermediateImage->view();
+    forEachTile(&mThreadPool, src.width, src.height, kBoxBlurHorizontalGrain,
+                [&src, &intermediate, radii, numBoxes](const Tile& tile, uint32_t) {
+                    boxBlurHorizontal(src, intermediate, radii, numBoxes, tile);
+                });
+    forEachTile(&mThreadPool, dst.width, dst.height, kBoxBlurVerticalGrain,
+                [&intermediate, &dst, radii, numBoxes](const Tile& tile, uint32_t) {
+                    boxBlurVertical(intermediate, dst, radii, numBoxes, tile);
+                });
+    return true;
+}
+
+}  // namespace cpu
+}  // namespace sample
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_PROCESSOR_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_PROCESSOR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Bitmap.h"
+#include "BoxBlur.h"
+#include "ColorMatrix.h"
+#include "CpuFeatures.h"
+#include "GaussianBlur.h"
+#include "Image.h"
+#include "PixelKernel.h"
+#include "RecursiveGaussian.h"
+#include "ThreadPool.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// The CPU counterpart of sample::ImageProcessor, applying the same filters to images in host
+// memory. Each filter splits the image into tiles processed in parallel by a thread pool.
+// It only depends on the C++ standard library, so it builds on any platform, and serves as the
+// fallback when Vulkan is unavailable.
+//
+// Unlike the Vulkan processor, the filters run synchronously: the output image holds the result
+// once the filter returns.
+class ImageProcessor {
+   public:
+    // Create an image processor running on numThreads threads, or one thread per core if
+    // numThreads is 0, with the SIMD kernels of simdLevel. Return nullptr if the level is not
+    // supported, see isSimdLevelSupported.
+    static std::unique_ptr<ImageProcessor> create(uint32_t numThreads = 0,
+                                                  SimdLevel simdLevel = getSimdLevel());
+
+    // Prefer ImageProcessor::create
+    ImageProcessor(uint32_t numThreads, SimdLevel simdLevel)
+        : mThreadPool(numThreads),
+          mBlurScratch(mThreadPool),
+          mRecursiveBlurScratch(mThreadPool),
+          mSimdLevel(simdLevel) {}
+
+    // Copy the input image and allocate the output images of the same size.
+    bool configureInputAndOutput(const BitmapView& input, int numberOfOutputImages);
+
+    // Get the indexed output image, which stays valid until the next configureInputAndOutput. The
+    // rows are aligned and padded, see Image.
+    BitmapView getOutputImage(int index) const;
+
+    // Apply a filter to the input image and write the results to the indexed output image, with
+    // the same parameters and results as sample::ImageProcessor up to rounding.
+    bool rotateHue(float radian, int outputIndex);
+    bool saturation(float saturation, int outputIndex);
+    bool blur(float radius, int outputIndex);
+
+    // Same as rotateHue with the given method, see ColorMatrixMethod. The lookup tables are built
+    // once per call, and shared by all the tiles.
+    bool rotateHue(float radian, int outputIndex, ColorMatrixMethod method);
+
+    // Approximate the gaussian blur of blur with a recursive filter, with a cost per pixel
+    // independent of the radius, see RecursiveGaussian.h. The radius must be within the range of
+    // [1.0, 500.0]. The approximation is coarse for small radii, where blur is also faster.
+    bool recursiveBlur(float radius, int outputIndex);
+
+    // Blur filters with a cost per pixel independent of the radius, with the same parameters and
+    // results as the box blurs of sample::ImageProcessor up to rounding. The radius must be within
+    // the range of [1.0, 500.0]. boxBlur applies a single box filter, and stackedBoxBlur applies
+    // three box filters approximating the gaussian of blur with the same radius.
+    bool boxBlur(float radius, int outputIndex);
+    bool stackedBoxBlur(float radius, int outputIndex);
+
+    // Rotate the hue by radian, mix each pixel with its luminance by the saturation, and map each
+    // channel through a lookup table of 256 entries, in a single pass over the image. The kernels
+    // of the three filters are fused, so the intermediate results are neither rounded nor clamped,
+    // see PixelKernel.h.
+    bool adjustColors(float radian, float saturation, const uint8_t* red, const uint8_t* green,
+                      const uint8_t* blue, const uint8_t* alpha, int outputIndex);
+
+    // Apply a pixel kernel, e.g. a chain of kernels fused with fuseKernels, to the input image and
+    // write the results to the indexed output image.
+    template <typename Kernel>
+    bool applyPixelKernel(const Kernel& kernel, int outputIndex) {
+        if (!isValidOutputIndex(outputIndex)) return false;
+        forEachPixel(&mThreadPool, mInputImage->view(),
+                     mOutputImages[static_cast<size_t>(outputIndex)]->view(), kernel);
+        return true;
+    }
+
+    // Same as above, but in place on the indexed output image, e.g. to run the kernels of a chain
+    // as separate passes.
+    template <typename Kernel>
+    bool applyPixelKernelInPlace(const Kernel& kernel, int outputIndex) {
+        if (!isValidOutputIndex(outputIndex)) return false;
+        const BitmapView& image = mOutputImages[static_cast<size_t>(outputIndex)]->view();
+        forEachPixel(&mThreadPool, image, image, kernel);
+        return true;
+    }
+
+    uint32_t numThreads() const { return mThreadPool.numThreads(); }
+    SimdLevel simdLevel() const { return mSimdLevel; }
+
+   private:
+    bool isValidOutputIndex(int index) const {
+        return index >= 0 && static_cast<size_t>(index) < mOutputImages.size();
+    }
+
+    // Apply numBoxes box filters of the given radii to the input image, horizontally into an
+    // intermediate image and then vertically into the indexed output image.
+    bool applyBoxBlurs(const int32_t* radii, uint32_t numBoxes, int outputIndex);
+
+    ThreadPool mThreadPool;
+    PerThread<GaussianBlurScratch> mBlurScratch;
+    PerThread<RecursiveGaussianScratch> mRecursiveBlurScratch;
+    const SimdLevel mSimdLevel;
+
+    // The pool is declared before the images, so that the images are destroyed first.
+    ImagePool mImagePool;
+    std::unique_ptr<Image> mInputImage;
+    std::vector<std::unique_ptr<Image>> mOutputImages;
+};
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_IMAGE_PROCESSOR_H
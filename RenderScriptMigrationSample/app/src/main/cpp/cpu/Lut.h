@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_LUT_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_LUT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Bitmap.h"
+#include "PixelKernel.h"
+
+namespace sample {
+namespace cpu {
+
+// The per-channel lookup tables of ScriptIntrinsicLUT as a pixel kernel, see PixelKernel.h. Each
+// channel is rounded to 8 bits and saturated, like the input of a separate pass, and mapped
+// through the table of the channel.
+class LutKernel {
+   public:
+    // Each table must hold 256 entries.
+    LutKernel(const uint8_t* red, const uint8_t* green, const uint8_t* blue,
+              const uint8_t* alpha) {
+        const uint8_t* const tables[] = {red, green, blue, alpha};
+        for (size_t c = 0; c < 4; c++) {
+            for (size_t v = 0; v < 256; v++) {
+                mTables[c][v] = static_cast<float>(tables[c][v]) * (1.0f / 255.0f);
+            }
+        }
+    }
+
+    float4 operator()(float4 pixel) const {
+        const float4 scaled = pixel * 255.0f;
+        float4 result = {};
+        for (size_t c = 0; c < 4; c++) result[c] = mTables[c][toUnorm8(scaled[c])];
+        return result;
+    }
+
+   private:
+    // The entries normalized to [0, 1], indexed by channel and value.
+    std::array<std::array<float, 256>, 4> mTables;
+};
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_LUT_H
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_PIXEL_KERNEL_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_PIXEL_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "Bitmap.h"
+#include "ThreadPool.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// Pixel kernels are the native counterpart of the RenderScript kernels mapping one uchar4 to
+// another, e.g. root(uchar4) in colormatrix.rs. A pixel kernel is a functor taking the RGBA
+// channels of a pixel normalized to [0, 1], like rsUnpackColor8888, and returning the new ones:
+//
+//     struct InvertKernel {
+//         float4 operator()(float4 pixel) const {
+//             return float4{1.0f - pixel[0], 1.0f - pixel[1], 1.0f - pixel[2], pixel[3]};
+//         }
+//     };
+//
+// A chain of kernels is fused with fuseKernels into a single kernel. The whole chain is inlined
+// into the loop of forEachPixel, which loads each pixel once, runs all the kernels on it in
+// registers, and stores it once, instead of making one pass over the image per kernel.
+//
+// The intermediate results of a fused chain stay in float, and are neither rounded to 8 bits nor
+// clamped to [0, 1] between the kernels. Where the separate passes keep every intermediate channel
+// within (0, 255), the fused chain differs from them by at most one rounding step per kernel,
+// scaled by the gain of the later kernels. A channel pushed out of range by a kernel is only
+// clamped at the end, so the later kernels see the unclamped value, and the results may differ
+// more.
+
+// The grain size of forEachPixel. The pixel kernels are cheap per pixel, so the tiles span whole
+// rows, and are only worth handing to another thread if they have enough rows.
+constexpr TileSize kPixelKernelGrain = {0, 8};
+
+// Load a pixel and normalize its channels to [0, 1].
+inline float4 loadUnorm8(const uint8_t* p) {
+    constexpr float kScale = 1.0f / 255.0f;
+    return float4{static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]),
+                  static_cast<float>(p[3])} *
+           kScale;
+}
+
+// Store a pixel with channels normalized to [0, 1], rounding to the nearest and saturating.
+inline void storeUnorm8(float4 value, uint8_t* p) {
+    const float4 scaled = value * 255.0f;
+    for (size_t c = 0; c < 4; c++) p[c] = toUnorm8(scaled[c]);
+}
+
+// The kernel applying Kernels in order, see fuseKernels.
+template <typename... Kernels>
+class FusedKernel {
+   public:
+    explicit FusedKernel(Kernels... kernels) : mKernels(std::move(kernels)...) {}
+
+    float4 operator()(float4 pixel) const {
+        return apply(pixel, std::index_sequence_for<Kernels...>{});
+    }
+
+   private:
+    template <size_t... I>
+    float4 apply(float4 pixel, std::index_sequence<I...>) const {
+        ((pixel = std::get<I>(mKernels)(pixel)), ...);
+        return pixel;
+    }
+
+    std::tuple<Kernels...> mKernels;
+};
+
+// Fuse the kernels into one kernel applying them from the first to the last. A fused kernel is a
+// kernel too, so it can be fused further.
+template <typename... Kernels>
+FusedKernel<Kernels...> fuseKernels(Kernels... kernels) {
+    return FusedKernel<Kernels...>(std::move(kernels)...);
+}
+
+// Apply the kernel to the tile of src, and write the results to the same tile of dst. The src and
+// dst bitmaps must have the same size, and may be the same bitmap.
+template <typename Kernel>
+void forEachPixel(const BitmapView& src, const BitmapView& dst, const Kernel& kernel,
+                  const Tile& tile) {
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        const uint8_t* in = src.pixel(tile.xBegin, y);
+        uint8_t* out = dst.pixel(tile.xBegin, y);
+        for (uint32_t x = tile.xBegin; x < tile.xEnd; x++, in += 4, out += 4) {
+            storeUnorm8(kernel(loadUnorm8(in)), out);
+        }
+    }
+}
+
+// Same as above over the whole image, in tiles of the grain size on the thread pool.
+template <typename Kernel>
+void forEachPixel(ThreadPool* pool, const BitmapView& src, const BitmapView& dst,
+                  const Kernel& kernel, TileSize grain = kPixelKernelGrain) {
+    forEachTile(pool, src.width, src.height, grain,
+                [&src, &dst, &kernel](const Tile& tile, uint32_t) {
+                    forEachPixel(src, dst, kernel, tile);
+                });
+}
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_PIXEL_KERNEL_H
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RecursiveGaussian.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sample {
+namespace cpu {
+namespace {
+
+// The order of the recursive filters, i.e. the number of previous outputs fed back.
+constexpr size_t kOrder = 3;
+
+// The number of rows filtered together by the horizontal pass.
+constexpr uint32_t kHorizontalTileHeight = 4;
+
+// The lines of a vertical tile should fit in the L2 cache of a core, see kMaxRollingBufferBytes of
+// GaussianBlur.cpp. The tiles are at least kMinVerticalTileWidth columns wide, to have enough
+// independent pixels in each step of the recursion.
+constexpr size_t kMaxVerticalTileBytes = 192 * 1024;
+constexpr size_t kMinVerticalTileWidth = 4;
+
+// The pixels are passed by pointer, as returning a vector wider than 16 bytes by value changes
+// the ABI depending on AVX on x86.
+void loadPixel(const uint8_t* p, double4* value) {
+    *value = double4{static_cast<double>(p[0]), static_cast<double>(p[1]),
+                     static_cast<double>(p[2]), static_cast<double>(p[3])};
+}
+
+void storePixel(const double4& value, uint8_t* p) {
+    for (size_t c = 0; c < 3; c++) p[c] = toUnorm8(static_cast<float>(value[c]));
+    p[3] = 0xff;
+}
+
+// Filter count interleaved lines of length samples in place. The sample n of the line i is at
+// lines[(n + kOrder) * count + i], and the kOrder rows of samples before and after the lines hold
+// the initial states of the causal and the anti-causal passes.
+void filterLines(double4* lines, size_t length, size_t count,
+                 const RecursiveGaussianCoefficients& c) {
+    double4* first = lines + kOrder * count;
+    double4* last = first + (length - 1) * count;
+    double4* end = last + count;
+
+    // Before the line, the input is the first sample repeated, so is the causal output, as the
+    // gain of the filter is 1. Save the last samples for the anti-causal initialization.
+    for (size_t k = 1; k <= kOrder; k++) std::copy(first, first + count, first - k * count);
+    std::copy(last, last + count, end);
+
+    for (double4* row = first; row != end; row += count) {
+        for (size_t i = 0; i < count; i++) {
+            row[i] = c.b * row[i] + c.a[0] * row[i - count] + c.a[1] * row[i - 2 * count] +
+                     c.a[2] * row[i - 3 * count];
+        }
+    }
+
+    // After the line, the input is the last sample u repeated. The response to the constant u is
+    // u, and the response to the deviation of the causal outputs from u is given by the matrix.
+    for (size_t i = 0; i < count; i++) {
+        const double4 u = end[i];
+        const double4 d[kOrder] = {last[i] - u, last[i - count] - u, last[i - 2 * count] - u};
+        for (size_t k = 0; k < kOrder; k++) {
+            end[k * count + i] = u + c.m[k][0] * d[0] + c.m[k][1] * d[1] + c.m[k][2] * d[2];
+        }
+    }
+
+    for (double4* row = last; row >= first; row -= count) {
+        for (size_t i = 0; i < count; i++) {
+            row[i] = c.b * row[i] + c.a[0] * row[i + count] + c.a[1] * row[i + 2 * count] +
+                     c.a[2] * row[i + 3 * count];
+        }
+    }
+}
+
+}  // namespace
+
+RecursiveGaussianCoefficients computeRecursiveGaussianCoefficients(float sigma) {
+    const auto s = static_cast<double>(sigma);
+    const double q =
+            s >= 2.5 ? 0.98711 * s - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * s);
+    const double q2 = q * q;
+    const double q3 = q2 * q;
+    const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+    RecursiveGaussianCoefficients c = {};
+    c.a[0] = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+    c.a[1] = -(1.4281 * q2 + 1.26661 * q3) / b0;
+    c.a[2] = 0.422205 * q3 / b0;
+    c.b = 1.0 - (c.a[0] + c.a[1] + c.a[2]);
+
+    // Compute the columns of the matrix numerically: the column j is the initial state of the
+    // anti-causal pass when the causal output j samples before the end is 1, and everything else
+    // is 0. Run the causal pass past the end of the line until the response vanishes, and the
+    // anti-causal pass back to the end.
+    const auto length = static_cast<size_t>(std::ceil(16.0 * q)) + 64;
+    std::vector<double> w(length + kOrder);
+    std::vector<double> y(length + kOrder);
+    for (size_t j = 0; j < kOrder; j++) {
+        std::fill(w.begin(), w.end(), 0.0);
+        std::fill(y.begin(), y.end(), 0.0);
+        // w[kOrder - 1 - j] is the causal output j samples before the end, at w[kOrder].
+        w[kOrder - 1 - j] = 1.0;
+        for (size_t n = kOrder; n < w.size(); n++) {
+            w[n] = c.a[0] * w[n - 1] + c.a[1] * w[n - 2] + c.a[2] * w[n - 3];
+        }
+        for (size_t n = length; n-- > 0;) {
+            y[n] = c.b * w[n + kOrder] + c.a[0] * y[n + 1] + c.a[1] * y[n + 2] +
+                   c.a[2] * y[n + 3];
+        }
+        for (size_t k = 0; k < kOrder; k++) c.m[k][j] = y[k];
+    }
+    return c;
+}
+
+TileSize getRecursiveGaussianHorizontalGrain(uint32_t /*width*/) {
+    return {0, kHorizontalTileHeight};
+}
+
+TileSize getRecursiveGaussianVerticalGrain(uint32_t height) {
+    const size_t lineBytes = (size_t{height} + 2 * kOrder) * sizeof(double4);
+    const size_t width = std::max(kMaxVerticalTileBytes / lineBytes, kMinVerticalTileWidth);
+    return {static_cast<uint32_t>(width), 0};
+}
+
+void recursiveGaussianHorizontal(const BitmapView& src, const BitmapView& dst,
+                                 const RecursiveGaussianCoefficients& coefficients,
+                                 const Tile& tile, RecursiveGaussianScratch* scratch) {
+    const size_t length = src.width;
+    const size_t count = tile.yEnd - tile.yBegin;
+    scratch->lines.resize(std::max(scratch->lines.size(), (length + 2 * kOrder) * count));
+    double4* samples = scratch->lines.data() + kOrder * count;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* in = src.row(tile.yBegin + static_cast<uint32_t>(i));
+        for (size_t x = 0; x < length; x++) loadPixel(in + x * 4, &samples[x * count + i]);
+    }
+    filterLines(scratch->lines.data(), length, count, coefficients);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* out = dst.row(tile.yBegin + static_cast<uint32_t>(i));
+        for (size_t x = 0; x < length; x++) storePixel(samples[x * count + i], out + x * 4);
+    }
+}
+
+void recursiveGaussianVertical(const BitmapView& dst,
+                               const RecursiveGaussianCoefficients& coefficients, const Tile& tile,
+                               RecursiveGaussianScratch* scratch) {
+    const size_t length = dst.height;
+    const size_t count = tile.xEnd - tile.xBegin;
+    scratch->lines.resize(std::max(scratch->lines.size(), (length + 2 * kOrder) * count));
+    double4* samples = scratch->lines.data() + kOrder * count;
+    for (uint32_t y = 0; y < length; y++) {
+        const uint8_t* in = dst.pixel(tile.xBegin, y);
+        for (size_t i = 0; i < count; i++) loadPixel(in + i * 4, &samples[y * count + i]);
+    }
+    filterLines(scratch->lines.data(), length, count, coefficients);
+    for (uint32_t y = 0; y < length; y++) {
+        uint8_t* out = dst.pixel(tile.xBegin, y);
+        for (size_t i = 0; i < count; i++) storePixel(samples[y * count + i], out + i * 4);
+    }
+}
+
+}  // namespace cpu
+}  // namespace sample
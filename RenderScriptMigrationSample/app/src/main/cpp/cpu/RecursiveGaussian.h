@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RECURSIVE_GAUSSIAN_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RECURSIVE_GAUSSIAN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bitmap.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// The maximum radius of the recursive gaussian blur, the same as the box blurs of
+// sample::ImageProcessor.
+constexpr float kMaxRecursiveGaussianRadius = 500.0f;
+
+// An RGBA pixel in double. The recursive filters of large sigmas have poles very close to 1, and
+// accumulate too much rounding error in float.
+using double4 = double __attribute__((vector_size(32)));
+
+// The coefficients of the third-order recursive gaussian filter of "Recursive implementation of
+// the Gaussian filter" (Young and van Vliet, 1995). Both the causal and the anti-causal passes
+// compute out[n] = b * in[n] + a[0] * out[n -+ 1] + a[1] * out[n -+ 2] + a[2] * out[n -+ 3].
+//
+// The matrix m initializes the anti-causal pass at the end of a line from the last three outputs
+// of the causal pass, so that the line is extended by clamping to edge, as in "Boundary
+// conditions for Young-van Vliet recursive filtering" (Triggs and Sdika, 2006).
+struct RecursiveGaussianCoefficients {
+    double b;
+    double a[3];
+    double m[3][3];
+};
+
+// Calculate the coefficients of the recursive gaussian filter with the standard deviation sigma,
+// which must be at least 0.5.
+RecursiveGaussianCoefficients computeRecursiveGaussianCoefficients(float sigma);
+
+// The scratch memory of the recursive gaussian passes, which can be reused across the calls on
+// the same thread.
+struct RecursiveGaussianScratch {
+    std::vector<double4> lines;
+};
+
+// The grain sizes of the passes. The horizontal pass runs on whole rows, and the vertical pass on
+// whole columns, grouped so that the lines of a tile fit in L2 cache.
+TileSize getRecursiveGaussianHorizontalGrain(uint32_t width);
+TileSize getRecursiveGaussianVerticalGrain(uint32_t height);
+
+// Apply the recursive gaussian filter horizontally from src to the tile of dst, or vertically to
+// the tile of dst in place, clamping to edge. The tiles must span whole rows and whole columns
+// respectively. The src and dst bitmaps must have the same size, and must not overlap. The alpha
+// channel of dst is set to 255.
+//
+// The cost per pixel is independent of sigma. The lines of a tile are filtered together, with the
+// samples of the lines interleaved, so that each step of the recursion runs on several
+// independent pixels.
+void recursiveGaussianHorizontal(const BitmapView& src, const BitmapView& dst,
+                                 const RecursiveGaussianCoefficients& coefficients,
+                                 const Tile& tile, RecursiveGaussianScratch* scratch);
+void recursiveGaussianVertical(const BitmapView& dst,
+                               const RecursiveGaussianCoefficients& coefficients, const Tile& tile,
+                               RecursiveGaussianScratch* scratch);
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RECURSIVE_GAUSSIAN_H
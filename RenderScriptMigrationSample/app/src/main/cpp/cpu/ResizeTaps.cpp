@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResizeTaps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace sample {
+namespace cpu {
+namespace {
+
+constexpr float kPi = 3.1415926535897932f;
+
+// Return the radius of the filter in input pixels when the scale is 1.
+float getFilterRadius(ResizeFilter filter) {
+    switch (filter) {
+        case ResizeFilter::kBilinear:
+            return 1.0f;
+        case ResizeFilter::kBicubic:
+            return 2.0f;
+        case ResizeFilter::kLanczos:
+            return 3.0f;
+    }
+    return 1.0f;
+}
+
+// Evaluate the filter at distance x, where |x| is less than the radius of the filter.
+float evaluateFilter(ResizeFilter filter, float x) {
+    x = std::fabs(x);
+    switch (filter) {
+        case ResizeFilter::kBilinear:
+            return 1.0f - x;
+        case ResizeFilter::kBicubic:
+            // Keys cubic with a = -0.5
+            if (x < 1.0f) return (1.5f * x - 2.5f) * x * x + 1.0f;
+            return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+        case ResizeFilter::kLanczos: {
+            if (x < 1e-6f) return 1.0f;
+            const float radius = getFilterRadius(filter);
+            const float px = kPi * x;
+            return radius * std::sin(px) * std::sin(px / radius) / (px * px);
+        }
+    }
+    return 0.0f;
+}
+
+}  // namespace
+
+ResizeTaps computeResizeTaps(ResizeFilter filter, uint32_t inputSize, uint32_t outputSize) {
+    const float scale = static_cast<float>(inputSize) / static_cast<float>(outputSize);
+    // Widen the filter by the scale factor when downsizing.
+    const float filterScale = std::max(scale, 1.0f);
+    const float support = getFilterRadius(filter) * filterScale;
+
+    // The taps of output pixel i are the input pixels within (center - support, center + support).
+    ResizeTaps taps;
+    taps.numTaps = static_cast<uint32_t>(std::ceil(2.0f * support));
+    taps.starts.resize(outputSize);
+    taps.weights.resize(size_t{outputSize} * taps.numTaps);
+    for (uint32_t i = 0; i < outputSize; i++) {
+        const float center = (static_cast<float>(i) + 0.5f) * scale - 0.5f;
+        const auto start = static_cast<int32_t>(std::floor(center - support)) + 1;
+        float* weights = taps.weights.data() + size_t{i} * taps.numTaps;
+        float sum = 0.0f;
+        for (uint32_t t = 0; t < taps.numTaps; t++) {
+            const float distance = (static_cast<float>(start) + static_cast<float>(t) - center);
+            const float x = distance / filterScale;
+            weights[t] = std::fabs(x) < getFilterRadius(filter) ? evaluateFilter(filter, x) : 0.0f;
+            sum += weights[t];
+        }
+        for (uint32_t t = 0; t < taps.numTaps; t++) {
+            weights[t] /= sum;
+        }
+        taps.starts[i] = start;
+    }
+    return taps;
+}
+
+}  // namespace cpu
+}  // namespace sample
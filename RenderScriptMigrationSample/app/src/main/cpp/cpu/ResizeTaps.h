@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RESIZE_TAPS_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RESIZE_TAPS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace sample {
+namespace cpu {
+
+// The resampling filters supported by the resize. The values are shared with the Java enum
+// VulkanImageProcessor.ResizeFilter.
+enum class ResizeFilter : int32_t {
+    // Triangle filter with a radius of 1.
+    kBilinear = 0,
+    // Catmull-Rom cubic filter with a radius of 2, as used by ScriptIntrinsicResize.
+    kBicubic = 1,
+    // Lanczos filter with a radius of 3.
+    kLanczos = 2,
+};
+
+// The precomputed filter taps of a 1D resize. Output pixel i is the weighted sum of numTaps
+// consecutive input pixels starting at starts[i], with the weights at
+// weights[i * numTaps, (i + 1) * numTaps). The input pixels outside of [0, inputSize) must be
+// clamped to the edge.
+struct ResizeTaps {
+    uint32_t numTaps = 0;
+    std::vector<int32_t> starts;
+    std::vector<float> weights;
+};
+
+// Compute the taps to resize a row or a column of inputSize pixels to outputSize pixels. The pixel
+// centers are aligned, i.e. output pixel i is centered at input coordinate
+// (i + 0.5) * inputSize / outputSize - 0.5. When downsizing, the filter is widened by the scale
+// factor to avoid aliasing. The weights of each output pixel sum up to 1.
+ResizeTaps computeResizeTaps(ResizeFilter filter, uint32_t inputSize, uint32_t outputSize);
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_RESIZE_TAPS_H
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Saturation.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace sample {
+namespace cpu {
+namespace {
+
+// The luminance weights of gMonoMult in Q8, summing up to 256.
+constexpr int16_t kLumaR = 77;
+constexpr int16_t kLumaG = 150;
+constexpr int16_t kLumaB = 29;
+
+constexpr int32_t kFractionBits = 8;
+constexpr int32_t kRounding = 1 << (kFractionBits - 1);
+
+// The difference of a channel to the luminance is shifted left by kDifferenceShift before the
+// rounding multiply-high by the Q8 saturation, which computes (a * b + 2^14) >> 15. So the
+// product is (difference * saturation + kRounding) >> kFractionBits, as in the scalar kernel.
+constexpr int32_t kDifferenceShift = 15 - kFractionBits;
+
+// Apply the Q8 saturation to width pixels. All the SIMD kernels compute the luminance as
+// (77 * r + 150 * g + 29 * b + kRounding) >> kFractionBits, and each channel as
+// luminance + ((channel - luminance) * saturation + kRounding) >> kFractionBits saturated to
+// [0, 255].
+void saturationQ8Scalar(const uint8_t* in, uint8_t* out, uint32_t width, int16_t s) {
+    for (uint32_t x = 0; x < width; x++, in += 4, out += 4) {
+        const int32_t luminance =
+                (kLumaR * in[0] + kLumaG * in[1] + kLumaB * in[2] + kRounding) >> kFractionBits;
+        for (size_t c = 0; c < 3; c++) {
+            const int32_t value =
+                    luminance + (((in[c] - luminance) * s + kRounding) >> kFractionBits);
+            out[c] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+        }
+        out[3] = 0xff;
+    }
+}
+
+#if defined(__ARM_NEON)
+
+// Compute the luminance of 8 pixels of the planar channels.
+uint8x8_t luminanceQ8(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t sum = vmull_u8(r, vdup_n_u8(kLumaR));
+    sum = vmlal_u8(sum, g, vdup_n_u8(kLumaG));
+    sum = vmlal_u8(sum, b, vdup_n_u8(kLumaB));
+    return vrshrn_n_u16(sum, kFractionBits);
+}
+
+// Mix one channel of 8 pixels with their luminance.
+uint8x8_t mixQ8(uint8x8_t channel, uint8x8_t luminance, int16x8_t s) {
+    const int16x8_t difference = vreinterpretq_s16_u16(vsubl_u8(channel, luminance));
+    const int16x8_t product = vqrdmulhq_s16(vshlq_n_s16(difference, kDifferenceShift), s);
+    return vqmovun_s16(vqaddq_s16(vreinterpretq_s16_u16(vmovl_u8(luminance)), product));
+}
+
+// Process 16 pixels per iteration, deinterleaved into channel planes by vld4.
+void saturationQ8Neon(const uint8_t* in, uint8_t* out, uint32_t width, int16_t s) {
+    const int16x8_t saturation = vdupq_n_s16(s);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t pixels = vld4q_u8(in + x * 4);
+        const uint8x8_t luminance[2] = {
+                luminanceQ8(vget_low_u8(pixels.val[0]), vget_low_u8(pixels.val[1]),
+                            vget_low_u8(pixels.val[2])),
+                luminanceQ8(vget_high_u8(pixels.val[0]), vget_high_u8(pixels.val[1]),
+                            vget_high_u8(pixels.val[2])),
+        };
+        uint8x16x4_t results;
+        for (size_t c = 0; c < 3; c++) {
+            results.val[c] =
+                    vcombine_u8(mixQ8(vget_low_u8(pixels.val[c]), luminance[0], saturation),
+                                mixQ8(vget_high_u8(pixels.val[c]), luminance[1], saturation));
+        }
+        results.val[3] = vdupq_n_u8(0xff);
+        vst4q_u8(out + x * 4, results);
+    }
+    saturationQ8Scalar(in + x * 4, out + x * 4, width - x, s);
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+
+// The x86 kernels process the pixels as interleaved RGBA widened to 16 bits, 2 pixels per 128
+// bits. The luminance is a multiply-add of the (R, G) and (B, A) pairs with the weights
+// (77, 150, 29, 0), followed by a horizontal add, and is then broadcast to the 4 channels of its
+// pixel. So the mix needs no deinterleaving. All the instructions operate within 128-bit lanes,
+// so the AVX2 kernel is the SSSE3 kernel with two lanes.
+
+// Mix 2 widened pixels with their broadcast luminance.
+__attribute__((target("ssse3"))) __m128i mixQ8Ssse3(__m128i pixels, __m128i luminance,
+                                                   __m128i s) {
+    const __m128i difference = _mm_slli_epi16(_mm_sub_epi16(pixels, luminance), kDifferenceShift);
+    return _mm_adds_epi16(luminance, _mm_mulhrs_epi16(difference, s));
+}
+
+// Process 4 pixels per vector, and 16 pixels per iteration.
+__attribute__((target("ssse3"))) void saturationQ8Ssse3(const uint8_t* in, uint8_t* out,
+                                                       uint32_t width, int16_t s) {
+    const __m128i weights = _mm_setr_epi16(kLumaR, kLumaG, kLumaB, 0, kLumaR, kLumaG, kLumaB, 0);
+    const __m128i rounding = _mm_set1_epi32(kRounding);
+    const __m128i saturation = _mm_set1_epi16(s);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xff000000));
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        for (uint32_t i = 0; i < 16; i += 4) {
+            const __m128i pixels =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (x + i) * 4));
+            const __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            const __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            const __m128i sum = _mm_hadd_epi32(_mm_madd_epi16(lo, weights),
+                                               _mm_madd_epi16(hi, weights));
+            // Y0 Y1 Y2 Y3 as 16 bits, then Y0 Y0 Y1 Y1 Y2 Y2 Y3 Y3, then each 4 times.
+            const __m128i luminance = _mm_packs_epi32(
+                    _mm_srai_epi32(_mm_add_epi32(sum, rounding), kFractionBits), zero);
+            const __m128i pairs = _mm_unpacklo_epi16(luminance, luminance);
+            const __m128i result =
+                    _mm_packus_epi16(mixQ8Ssse3(lo, _mm_unpacklo_epi32(pairs, pairs), saturation),
+                                     mixQ8Ssse3(hi, _mm_unpackhi_epi32(pairs, pairs), saturation));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x + i) * 4),
+                             _mm_or_si128(result, alpha));
+        }
+    }
+    saturationQ8Scalar(in + x * 4, out + x * 4, width - x, s);
+}
+
+__attribute__((target("avx2"))) __m256i mixQ8Avx2(__m256i pixels, __m256i luminance, __m256i s) {
+    const __m256i difference =
+            _mm256_slli_epi16(_mm256_sub_epi16(pixels, luminance), kDifferenceShift);
+    return _mm256_adds_epi16(luminance, _mm256_mulhrs_epi16(difference, s));
+}
+
+// Process 8 pixels per vector, and 32 pixels per iteration.
+__attribute__((target("avx2"))) void saturationQ8Avx2(const uint8_t* in, uint8_t* out,
+                                                     uint32_t width, int16_t s) {
+    const __m256i weights = _mm256_broadcastsi128_si256(
+            _mm_setr_epi16(kLumaR, kLumaG, kLumaB, 0, kLumaR, kLumaG, kLumaB, 0));
+    const __m256i rounding = _mm256_set1_epi32(kRounding);
+    const __m256i saturation = _mm256_set1_epi16(s);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int32_t>(0xff000000));
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        for (uint32_t i = 0; i < 32; i += 8) {
+            const __m256i pixels =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (x + i) * 4));
+            const __m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+            const __m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+            const __m256i sum = _mm256_hadd_epi32(_mm256_madd_epi16(lo, weights),
+                                                  _mm256_madd_epi16(hi, weights));
+            const __m256i luminance = _mm256_packs_epi32(
+                    _mm256_srai_epi32(_mm256_add_epi32(sum, rounding), kFractionBits), zero);
+            const __m256i pairs = _mm256_unpacklo_epi16(luminance, luminance);
+            const __m256i result = _mm256_packus_epi16(
+                    mixQ8Avx2(lo, _mm256_unpacklo_epi32(pairs, pairs), saturation),
+                    mixQ8Avx2(hi, _mm256_unpackhi_epi32(pairs, pairs), saturation));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (x + i) * 4),
+                                _mm256_or_si256(result, alpha));
+        }
+    }
+    saturationQ8Ssse3(in + x * 4, out + x * 4, width - x, s);
+}
+
+#endif
+
+int16_t quantizeSaturation(float saturation) {
+    const long value = std::lround(saturation * (1 << kFractionBits));
+    return static_cast<int16_t>(std::clamp(value, long{INT16_MIN}, long{INT16_MAX}));
+}
+
+}  // namespace
+
+void saturation(const BitmapView& src, const BitmapView& dst, float saturation, const Tile& tile,
+                SimdLevel level) {
+    auto kernel = saturationQ8Scalar;
+#if defined(__ARM_NEON)
+    if (level == SimdLevel::kNeon) kernel = saturationQ8Neon;
+#elif defined(__x86_64__) || defined(__i386__)
+    if (level == SimdLevel::kSsse3) kernel = saturationQ8Ssse3;
+    if (level == SimdLevel::kAvx2) kernel = saturationQ8Avx2;
+#else
+    (void)level;
+#endif
+    const int16_t s = quantizeSaturation(saturation);
+    const uint32_t width = tile.xEnd - tile.xBegin;
+    for (uint32_t y = tile.yBegin; y < tile.yEnd; y++) {
+        kernel(src.pixel(tile.xBegin, y), dst.pixel(tile.xBegin, y), width, s);
+    }
+}
+
+}  // namespace cpu
+}  // namespace sample
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_SATURATION_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_SATURATION_H
+
+#include <cstdint>
+
+#include "Bitmap.h"
+#include "CpuFeatures.h"
+#include "PixelKernel.h"
+#include "TileLauncher.h"
+
+namespace sample {
+namespace cpu {
+
+// The saturation adjustment of saturation.rs in BasicRenderScript: each pixel is mixed with its
+// luminance, dot(rgb, {0.299, 0.587, 0.114}), by the saturation. A saturation of 0 turns the image
+// to grayscale, 1 keeps it unchanged, and values above 1 exaggerate the colors.
+
+// The saturation as a pixel kernel, see PixelKernel.h. The alpha channel is set to 1.
+class SaturationKernel {
+   public:
+    explicit SaturationKernel(float saturation) : mSaturation(saturation) {}
+
+    float4 operator()(float4 pixel) const {
+        const float luminance = 0.299f * pixel[0] + 0.587f * pixel[1] + 0.114f * pixel[2];
+        const float4 result = luminance + (pixel - luminance) * mSaturation;
+        return float4{result[0], result[1], result[2], 1.0f};
+    }
+
+   private:
+    float mSaturation;
+};
+
+// Apply the saturation to the tile of src, and write the results to the same tile of dst. The src
+// and dst bitmaps must have the same size. The alpha channel of dst is set to 255.
+//
+// The luminance is computed with Q8 weights, and mixed with the channels by the saturation in Q8,
+// clamped to (-128, 128), all in 16-bit integers and vectorized for the SIMD level, which must be
+// supported. The results are the same at all levels, and within 1 of SaturationKernel for the
+// saturations within [0, 2] of the BasicRenderScript sample.
+void saturation(const BitmapView& src, const BitmapView& dst, float saturation, const Tile& tile,
+                SimdLevel level = getSimdLevel());
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_SATURATION_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace sample {
+namespace cpu {
+namespace {
+
+uint32_t getNumThreads(uint32_t numThreads) {
+    return numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(uint32_t numThreads)
+    : mNumThreads(getNumThreads(numThreads)), mTaskRanges(new TaskRange[mNumThreads]) {
+    for (uint32_t thread = 1; thread < mNumThreads; thread++) {
+        mWorkers.emplace_back([this, thread] { workerLoop(thread); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWorkAvailable.notify_all();
+    for (auto& worker : mWorkers) worker.join();
+}
+
+void ThreadPool::parallelFor(uint32_t numTasks,
+                             const std::function<void(uint32_t, uint32_t)>& task) {
+    if (numTasks == 0) return;
+    if (mWorkers.empty() || numTasks == 1) {
+        for (uint32_t i = 0; i < numTasks; i++) task(i, 0);
+        return;
+    }
+
+    // Hand out contiguous shares of the tasks.
+    for (uint32_t thread = 0; thread < mNumThreads; thread++) {
+        TaskRange& range = mTaskRanges[thread];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        range.begin = static_cast<uint32_t>(uint64_t{numTasks} * thread / mNumThreads);
+        range.end = static_cast<uint32_t>(uint64_t{numTasks} * (thread + 1) / mNumThreads);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mNumBusyWorkers = mWorkers.size();
+        mGeneration++;
+    }
+    mWorkAvailable.notify_all();
+    runTasks(0);
+
+    // Wait for all the workers, including the ones that found no task left, so that none of them
+    // still refers to the task when the next call starts.
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this] { return mNumBusyWorkers == 0; });
+    mTask = nullptr;
+}
+
+void ThreadPool::workerLoop(uint32_t thread) {
+    uint64_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkAvailable.wait(lock, [this, generation] {
+                return mStopping || mGeneration != generation;
+            });
+            if (mStopping) return;
+            generation = mGeneration;
+        }
+        runTasks(thread);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mNumBusyWorkers--;
+        }
+        mWorkDone.notify_one();
+    }
+}
+
+void ThreadPool::runTasks(uint32_t thread) {
+    const auto& task = *mTask;
+    do {
+        uint32_t i = 0;
+        while (popTask(thread, &i)) task(i, thread);
+    } while (stealTasks(thread));
+}
+
+bool ThreadPool::popTask(uint32_t thread, uint32_t* task) {
+    TaskRange& range = mTaskRanges[thread];
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin == range.end) return false;
+    *task = range.begin++;
+    return true;
+}
+
+bool ThreadPool::stealTasks(uint32_t thread) {
+    for (uint32_t i = 1; i < mNumThreads; i++) {
+        TaskRange& victim = mTaskRanges[(thread + i) % mNumThreads];
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            const uint32_t remaining = victim.end - victim.begin;
+            if (remaining == 0) continue;
+            end = victim.end;
+            begin = end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+        // The own range is empty, and only the owner refills it.
+        TaskRange& own = mTaskRanges[thread];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace cpu
+}  // namespace sample
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_THREAD_POOL_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sample {
+namespace cpu {
+
+// A persistent pool of worker threads running the tasks of ThreadPool::parallelFor with work
+// stealing. The calling thread runs tasks too, so a pool of N threads starts N - 1 workers.
+//
+// Each thread starts with a contiguous share of the tasks, and runs them from the front. Once its
+// own tasks run out, it steals the back half of the tasks left to another thread. So neighboring
+// tasks, e.g. neighboring tiles of an image, mostly run on the same thread, while uneven tasks are
+// still balanced across the threads.
+class ThreadPool {
+   public:
+    // Create a pool with numThreads threads including the calling thread, or one thread per core
+    // if numThreads is 0.
+    explicit ThreadPool(uint32_t numThreads = 0);
+    ~ThreadPool();
+
+    // Non-copyable
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t numThreads() const { return mNumThreads; }
+
+    // Run task(i, thread) for each i in [0, numTasks), and block until all the tasks have
+    // finished. The thread within [0, numThreads) is the index of the running thread, 0 for the
+    // calling thread, e.g. to index per-thread scratch memory. Must not be called concurrently,
+    // or from within a task.
+    void parallelFor(uint32_t numTasks, const std::function<void(uint32_t, uint32_t)>& task);
+
+   private:
+    // The tasks [begin, end) not started yet by a thread. The owner takes the tasks from the
+    // front, and the other threads steal from the back. Each range is on its own cache line.
+    struct alignas(64) TaskRange {
+        std::mutex mutex;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    void workerLoop(uint32_t thread);
+
+    // Run the tasks of the thread, and steal tasks until there are none left.
+    void runTasks(uint32_t thread);
+    bool popTask(uint32_t thread, uint32_t* task);
+    bool stealTasks(uint32_t thread);
+
+    const uint32_t mNumThreads;
+    std::unique_ptr<TaskRange[]> mTaskRanges;
+    std::vector<std::thread> mWorkers;
+
+    // The current parallelFor call, guarded by mMutex. A new call increments mGeneration, and the
+    // workers count down mNumBusyWorkers once there are no tasks left to steal.
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mWorkDone;
+    const std::function<void(uint32_t, uint32_t)>* mTask = nullptr;
+    uint64_t mGeneration = 0;
+    size_t mNumBusyWorkers = 0;
+    bool mStopping = false;
+};
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_THREAD_POOL_H
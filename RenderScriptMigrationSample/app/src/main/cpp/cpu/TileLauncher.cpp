@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TileLauncher.h"
+
+#include <algorithm>
+
+namespace sample {
+namespace cpu {
+
+void forEachTile(ThreadPool* pool, uint32_t width, uint32_t height, TileSize grain,
+                 const std::function<void(const Tile&, uint32_t)>& kernel) {
+    if (width == 0 || height == 0) return;
+    const uint32_t tileWidth = grain.width == 0 ? width : std::min(grain.width, width);
+    const uint32_t tileHeight = grain.height == 0 ? height : std::min(grain.height, height);
+    const uint32_t numTilesX = (width + tileWidth - 1) / tileWidth;
+    const uint32_t numTilesY = (height + tileHeight - 1) / tileHeight;
+    pool->parallelFor(numTilesX * numTilesY, [&](uint32_t i, uint32_t thread) {
+        const uint32_t x = i % numTilesX * tileWidth;
+        const uint32_t y = i / numTilesX * tileHeight;
+        const Tile tile = {x, std::min(x + tileWidth, width), y, std::min(y + tileHeight, height)};
+        kernel(tile, thread);
+    });
+}
+
+}  // namespace cpu
+}  // namespace sample
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RENDERSCRIPT_MIGRATION_SAMPLE_CPU_TILE_LAUNCHER_H
+#define RENDERSCRIPT_MIGRATION_SAMPLE_CPU_TILE_LAUNCHER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ThreadPool.h"
+
+namespace sample {
+namespace cpu {
+
+// A rectangle [xBegin, xEnd) x [yBegin, yEnd) of a launch domain.
+struct Tile {
+    uint32_t xBegin;
+    uint32_t xEnd;
+    uint32_t yBegin;
+    uint32_t yEnd;
+};
+
+// The grain size of a launch, i.e. the size of the tiles. The tiles at the right and bottom edges
+// are cut to the domain. A width or height of 0 spans the whole domain in that direction.
+struct TileSize {
+    uint32_t width;
+    uint32_t height;
+};
+
+// The launcher of the CPU kernels, the native counterpart of the RenderScript forEach. Split the
+// width x height domain into tiles of the grain size, and run kernel(tile, thread) for each tile
+// on the thread pool. The tiles are ordered row by row, so each thread starts with a band of
+// neighboring tiles, see ThreadPool. The thread indexes per-thread data, see PerThread.
+void forEachTile(ThreadPool* pool, uint32_t width, uint32_t height, TileSize grain,
+                 const std::function<void(const Tile&, uint32_t)>& kernel);
+
+// An instance of T for each thread of a pool, e.g. the scratch memory of a kernel, indexed by the
+// thread passed to the kernel. The instances are on separate cache lines to avoid false sharing.
+template <typename T>
+class PerThread {
+   public:
+    explicit PerThread(const ThreadPool& pool) : mInstances(pool.numThreads()) {}
+
+    T& operator[](uint32_t thread) { return mInstances[thread].value; }
+
+   private:
+    struct alignas(64) Instance {
+        T value;
+    };
+    std::vector<Instance> mInstances;
+};
+
+}  // namespace cpu
+}  // namespace sample
+
+#endif  // RENDERSCRIPT_MIGRATION_SAMPLE_CPU_TILE_LAUNCHER_H
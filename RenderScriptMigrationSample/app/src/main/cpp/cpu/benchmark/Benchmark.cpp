@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A benchmark of the CPU image processor, sweeping the filters and their parameters over image
+// sizes, SIMD levels and thread counts. The results are written as JSON, e.g.
+//
+//     rs_migration_cpu_benchmark --sizes=1920x1080 --min-time-ms=500 --output=results.json
+//
+// For each case, the filter runs until both kMinIterations and the minimum time are reached, and
+// the latency is reported as the min, median and 99th percentile, along with the throughput of
+// the median in megapixels and bytes per second. The bytes count one read and one write of each
+// pixel per pass of the pixel filters, and are null for the blurs.
+//
+// The results are followed by the accuracy of recursiveBlur against blur, the FIR filter it
+// approximates, as the max absolute error and the PSNR over the RGB channels.
+//
+// The filters without SIMD paths, i.e. the blurs and the pixel kernels, run once per thread count
+// with the "cpu" backend, rather than once per SIMD level. Only the CPU processor is covered, as
+// the benchmark runs on the host without a Vulkan device. The timings of the Vulkan processor are
+// measured on the device by GoldenImageTest.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CpuFeatures.h"
+#include "ImageProcessor.h"
+#include "Lut.h"
+#include "Saturation.h"
+
+namespace sample {
+namespace cpu {
+namespace {
+
+constexpr uint32_t kNumWarmupIterations = 3;
+constexpr uint32_t kMinIterations = 10;
+constexpr uint32_t kMaxIterations = 10000;
+
+// The radii at which recursiveBlur is compared with blur, within the range of both.
+constexpr float kAccuracyRadii[] = {1.0f, 5.0f, 10.0f, 25.0f};
+
+struct Options {
+    std::vector<std::pair<uint32_t, uint32_t>> sizes = {{640, 480}, {1920, 1080}, {3840, 2160}};
+    double minTimeMs = 200.0;
+    const char* output = nullptr;
+};
+
+struct Filter {
+    const char* name;
+    const char* parameterName;
+    std::vector<float> parameters;
+    std::function<bool(ImageProcessor*, float)> run;
+    // Whether the filter has a path per SimdLevel, see ImageProcessor::create.
+    bool usesSimdLevel;
+    // The bytes read and written per pixel, or 0 if not meaningful for the filter.
+    double bytesPerPixel;
+};
+
+struct Case {
+    const Filter* filter;
+    float parameter;
+    uint32_t width;
+    uint32_t height;
+    SimdLevel simdLevel;
+    uint32_t numThreads;
+};
+
+struct Result {
+    uint32_t iterations;
+    double minMs;
+    double medianMs;
+    double p99Ms;
+};
+
+// Close the output file, but not stdout.
+struct FileCloser {
+    void operator()(FILE* file) const {
+        if (file != stdout) std::fclose(file);
+    }
+};
+
+struct Accuracy {
+    uint32_t maxAbsError;
+    double psnr;
+};
+
+bool parseSizes(const char* value, std::vector<std::pair<uint32_t, uint32_t>>* sizes) {
+    sizes->clear();
+    const char* p = value;
+    while (*p != '\0') {
+        char* end = nullptr;
+        const unsigned long width = std::strtoul(p, &end, 10);
+        if (*end != 'x') return false;
+        const unsigned long height = std::strtoul(end + 1, &end, 10);
+        if (width == 0 || height == 0 || (*end != ',' && *end != '\0')) return false;
+        sizes->emplace_back(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        p = *end == ',' ? end + 1 : end;
+    }
+    return !sizes->empty();
+}
+
+bool parseOptions(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const size_t separator = arg.find('=');
+        const std::string name = arg.substr(0, separator);
+        const char* value = separator == std::string::npos ? "" : argv[i] + separator + 1;
+        if (name == "--sizes") {
+            if (!parseSizes(value, &options->sizes)) return false;
+        } else if (name == "--min-time-ms") {
+            options->minTimeMs = std::strtod(value, nullptr);
+            if (options->minTimeMs <= 0.0) return false;
+        } else if (name == "--output") {
+            options->output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Return the value at the percentile of the sorted samples, with the nearest-rank method.
+double getPercentile(const std::vector<double>& sorted, double percentile) {
+    const double size = static_cast<double>(sorted.size());
+    const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * size));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// Fill an image with random pixels, the same for each size.
+std::vector<uint8_t> createInput(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> pixels(size_t{width} * height * 4);
+    std::mt19937 random(0);
+    for (auto& value : pixels) value = static_cast<uint8_t>(random());
+    return pixels;
+}
+
+// Compare the RGB channels of the images, as the alpha channel of the outputs is always 255.
+Accuracy compareImages(const BitmapView& expected, const BitmapView& actual) {
+    uint32_t maxAbsError = 0;
+    double sumSquaredError = 0.0;
+    for (uint32_t y = 0; y < expected.height; y++) {
+        for (uint32_t x = 0; x < expected.width; x++) {
+            for (size_t c = 0; c < 3; c++) {
+                const int error = expected.pixel(x, y)[c] - actual.pixel(x, y)[c];
+                const auto absError = static_cast<uint32_t>(std::abs(error));
+                maxAbsError = std::max(maxAbsError, absError);
+                sumSquaredError += static_cast<double>(absError * absError);
+            }
+        }
+    }
+    if (maxAbsError == 0) return {0, std::numeric_limits<double>::infinity()};
+    const double meanSquaredError = sumSquaredError / (3.0 * expected.width * expected.height);
+    return {maxAbsError, 10.0 * std::log10(255.0 * 255.0 / meanSquaredError)};
+}
+
+bool runCase(ImageProcessor* processor, const Case& benchmarkCase, double minTimeMs,
+             Result* result) {
+    using Clock = std::chrono::steady_clock;
+    const Filter& filter = *benchmarkCase.filter;
+    const float parameter = benchmarkCase.parameter;
+    for (uint32_t i = 0; i < kNumWarmupIterations; i++) {
+        if (!filter.run(processor, parameter)) return false;
+    }
+    std::vector<double> samples;
+    double totalMs = 0.0;
+    while (samples.size() < kMaxIterations &&
+           (samples.size() < kMinIterations || totalMs < minTimeMs)) {
+        const auto start = Clock::now();
+        if (!filter.run(processor, parameter)) return false;
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        samples.push_back(ms);
+        totalMs += ms;
+    }
+    std::sort(samples.begin(), samples.end());
+    *result = {static_cast<uint32_t>(samples.size()), samples.front(),
+               getPercentile(samples, 50.0), getPercentile(samples, 99.0)};
+    return true;
+}
+
+void writeResult(FILE* out, const Case& benchmarkCase, const Result& result) {
+    const double numPixels =
+            static_cast<double>(benchmarkCase.width) * static_cast<double>(benchmarkCase.height);
+    const double seconds = result.medianMs / 1000.0;
+    std::fprintf(out, "    {\"filter\": \"%s\", \"%s\": %g, ", benchmarkCase.filter->name,
+                 benchmarkCase.filter->parameterName, static_cast<double>(benchmarkCase.parameter));
+    std::fprintf(out, "\"width\": %u, \"height\": %u, ", benchmarkCase.width,
+                 benchmarkCase.height);
+    if (benchmarkCase.filter->usesSimdLevel) {
+        std::fprintf(out, "\"backend\": \"cpu-%s\", ", getSimdLevelName(benchmarkCase.simdLevel));
+    } else {
+        std::fprintf(out, "\"backend\": \"cpu\", ");
+    }
+    std::fprintf(out, "\"threads\": %u, ", benchmarkCase.numThreads);
+    std::fprintf(out, "\"iterations\": %u, \"min_ms\": %.4f, ", result.iterations, result.minMs);
+    std::fprintf(out, "\"median_ms\": %.4f, \"p99_ms\": %.4f, ", result.medianMs, result.p99Ms);
+    std::fprintf(out, "\"megapixels_per_second\": %.2f, \"bytes_per_second\": ",
+                 numPixels / seconds / 1e6);
+    const double bytesPerPixel = benchmarkCase.filter->bytesPerPixel;
+    if (bytesPerPixel > 0.0) {
+        std::fprintf(out, "%.0f}", numPixels * bytesPerPixel / seconds);
+    } else {
+        std::fprintf(out, "null}");
+    }
+}
+
+void writeAccuracy(FILE* out, float radius, uint32_t width, uint32_t height,
+                   const Accuracy& accuracy) {
+    std::fprintf(out, "    {\"filter\": \"recursiveBlur\", \"reference\": \"blur\", ");
+    std::fprintf(out, "\"radius\": %g, \"width\": %u, \"height\": %u, ",
+                 static_cast<double>(radius), width, height);
+    // JSON has no infinity, so identical images have a null PSNR.
+    std::fprintf(out, "\"max_abs_error\": %u, \"psnr\": ", accuracy.maxAbsError);
+    if (std::isinf(accuracy.psnr)) {
+        std::fprintf(out, "null}");
+    } else {
+        std::fprintf(out, "%.2f}", accuracy.psnr);
+    }
+}
+
+bool runAccuracy(FILE* out, const Options& options) {
+    auto processor = ImageProcessor::create();
+    if (processor == nullptr) return false;
+    bool first = true;
+    for (const auto& [width, height] : options.sizes) {
+        std::vector<uint8_t> pixels = createInput(width, height);
+        const BitmapView input = {pixels.data(), width, height, size_t{width} * 4};
+        if (!processor->configureInputAndOutput(input, 2)) return false;
+        for (const float radius : kAccuracyRadii) {
+            if (!processor->blur(radius, 0) || !processor->recursiveBlur(radius, 1)) return false;
+            const Accuracy accuracy =
+                    compareImages(processor->getOutputImage(0), processor->getOutputImage(1));
+            std::fprintf(out, first ? "\n" : ",\n");
+            writeAccuracy(out, radius, width, height, accuracy);
+            first = false;
+        }
+    }
+    return true;
+}
+
+int runBenchmark(const Options& options) {
+    const std::unique_ptr<FILE, FileCloser> file(
+            options.output != nullptr ? std::fopen(options.output, "w") : stdout);
+    if (file == nullptr) {
+        std::fprintf(stderr, "Failed to open %s\n", options.output);
+        return EXIT_FAILURE;
+    }
+    FILE* out = file.get();
+
+    // The lookup table of adjustColors, with the same table for each color channel.
+    std::array<uint8_t, 256> table;
+    std::array<uint8_t, 256> identity;
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = static_cast<uint8_t>(32 + i * 3 / 4);
+        identity[i] = static_cast<uint8_t>(i);
+    }
+    constexpr float kAdjustColorsSaturation = 1.5f;
+
+    // The pixel filters read and write each pixel once per pass. The traffic of the blurs depends
+    // on their intermediate buffers and caching, so they report no bytes per second.
+    const std::vector<Filter> filters = {
+            {"rotateHue", "radian", {-2.0f, 0.5f, 3.0f},
+             [](ImageProcessor* p, float radian) { return p->rotateHue(radian, 0); }, true, 8.0},
+            {"rotateHue/lut", "radian", {-2.0f, 0.5f, 3.0f},
+             [](ImageProcessor* p, float radian) {
+                 return p->rotateHue(radian, 0, ColorMatrixMethod::kLookupTable);
+             },
+             true, 8.0},
+            // The float kernel, the baseline of the fixed point and lookup table methods.
+            {"rotateHue/float", "radian", {-2.0f, 0.5f, 3.0f},
+             [](ImageProcessor* p, float radian) {
+                 return p->rotateHue(radian, 0, ColorMatrixMethod::kFloat);
+             },
+             false, 8.0},
+            {"saturation", "saturation", {0.0f, 0.5f, 2.0f},
+             [](ImageProcessor* p, float saturation) { return p->saturation(saturation, 0); },
+             true, 8.0},
+            // The hue rotation, saturation and lookup tables fused into a single pass, and the
+            // same kernels run as three passes.
+            {"adjustColors", "radian", {-2.0f, 0.5f, 3.0f},
+             [&table, &identity](ImageProcessor* p, float radian) {
+                 return p->adjustColors(radian, kAdjustColorsSaturation, table.data(),
+                                        table.data(), table.data(), identity.data(), 0);
+             },
+             false, 8.0},
+            {"adjustColors/unfused", "radian", {-2.0f, 0.5f, 3.0f},
+             [&table, &identity](ImageProcessor* p, float radian) {
+                 return p->applyPixelKernel(ColorMatrixKernel(computeHueRotationMatrix(radian)),
+                                            0) &&
+                        p->applyPixelKernelInPlace(SaturationKernel(kAdjustColorsSaturation), 0) &&
+                        p->applyPixelKernelInPlace(LutKernel(table.data(), table.data(),
+                                                             table.data(), identity.data()),
+                                                   0);
+             },
+             false, 24.0},
+            {"blur", "radius", {1.0f, 5.0f, 10.0f, 25.0f},
+             [](ImageProcessor* p, float radius) { return p->blur(radius, 0); }, false, 0.0},
+            {"recursiveBlur", "radius", {1.0f, 5.0f, 10.0f, 25.0f, 100.0f, 500.0f},
+             [](ImageProcessor* p, float radius) { return p->recursiveBlur(radius, 0); },
+             false, 0.0},
+            {"boxBlur", "radius", {1.0f, 5.0f, 25.0f, 100.0f, 500.0f},
+             [](ImageProcessor* p, float radius) { return p->boxBlur(radius, 0); }, false, 0.0},
+            {"stackedBoxBlur", "radius", {1.0f, 5.0f, 25.0f, 100.0f, 500.0f},
+             [](ImageProcessor* p, float radius) { return p->stackedBoxBlur(radius, 0); },
+             false, 0.0},
+    };
+    std::vector<SimdLevel> simdLevels = {SimdLevel::kScalar};
+    if (getSimdLevel() != SimdLevel::kScalar) simdLevels.push_back(getSimdLevel());
+    // A single thread, and one thread per core.
+    std::vector<uint32_t> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1) threadCounts.push_back(0);
+
+    std::fprintf(out, "{\n  \"simd_level\": \"%s\",\n  \"results\": [",
+                 getSimdLevelName(getSimdLevel()));
+    bool first = true;
+    for (const auto& [width, height] : options.sizes) {
+        std::vector<uint8_t> pixels = createInput(width, height);
+        const BitmapView input = {pixels.data(), width, height, size_t{width} * 4};
+        for (const SimdLevel simdLevel : simdLevels) {
+            for (const uint32_t threads : threadCounts) {
+                auto processor = ImageProcessor::create(threads, simdLevel);
+                if (processor == nullptr || !processor->configureInputAndOutput(input, 1)) {
+                    std::fprintf(stderr, "Failed to create the processor\n");
+                    return EXIT_FAILURE;
+                }
+                for (const auto& filter : filters) {
+                    // Run the filters without SIMD paths only once, at the detected level.
+                    if (!filter.usesSimdLevel && simdLevel != simdLevels.back()) continue;
+                    for (const float parameter : filter.parameters) {
+                        const Case benchmarkCase = {&filter, parameter, width, height, simdLevel,
+                                                    processor->numThreads()};
+                        Result result;
+                        if (!runCase(processor.get(), benchmarkCase, options.minTimeMs, &result)) {
+                            std::fprintf(stderr, "Failed to run %s\n", filter.name);
+                            return EXIT_FAILURE;
+                        }
+                        std::fprintf(out, first ? "\n" : ",\n");
+                        writeResult(out, benchmarkCase, result);
+                        std::fflush(out);
+                        first = false;
+                    }
+                }
+            }
+        }
+    }
+    std::fprintf(out, "\n  ],\n  \"accuracy\": [");
+    if (!runAccuracy(out, options)) {
+        std::fprintf(stderr, "Failed to compare recursiveBlur with blur\n");
+        return EXIT_FAILURE;
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+    return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace sample
+
+int main(int argc, char** argv) {
+    sample::cpu::Options options;
+    if (!sample::cpu::parseOptions(argc, argv, &options)) {
+        std::fprintf(stderr,
+                     "Usage: %s [--sizes=WxH[,WxH...]] [--min-time-ms=MS] [--output=FILE]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+    return sample::cpu::runBenchmark(options);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import android.graphics.Bitmap
+
+// The image processor backed by the native CPU implementation in cpu/ImageProcessor.h. The filters
+// run synchronously on a work-stealing thread pool, with the image split into tiles across the
+// cores. It does not depend on any GPU API, so it is also the fallback when Vulkan is unavailable.
+class CpuImageProcessor(numThreads: Int = 0) : ImageProcessor {
+    override val name = "Native CPU"
+
+    private var mCpuProcessor = initCpuProcessor(numThreads)
+
+    init {
+        if (mCpuProcessor == 0L) {
+            throw RuntimeException("Failed to initialize CPU processor")
+        }
+    }
+
+    private lateinit var mOutputImages: Array<Bitmap>
+
+    // Native methods
+
+    // Initialize the image processor running on numThreads threads, or one per core if 0.
+    // Return a non-zero handle on success, and 0L if failed.
+    private external fun initCpuProcessor(numThreads: Int): Long
+
+    // Copy the input image from bitmap and allocate the native output images.
+    // Return true on success, and false if failed.
+    private external fun configureInputAndOutput(
+        processor: Long,
+        inputBitmap: Bitmap,
+        numberOfOutputImages: Int
+    ): Boolean
+
+    // Apply the hue rotation filter to the indexed native output image, and copy it to the
+    // ARGB_8888 outputBitmap of the input size.
+    private external fun rotateHue(
+        processor: Long,
+        radian: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the saturation filter to the indexed native output image, and copy it to the ARGB_8888
+    // outputBitmap of the input size.
+    private external fun saturation(
+        processor: Long,
+        saturation: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the blur filter to the indexed native output image, and copy it to the ARGB_8888
+    // outputBitmap of the input size.
+    private external fun blur(
+        processor: Long,
+        radius: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the recursive blur filter to the indexed native output image, and copy it to the
+    // ARGB_8888 outputBitmap of the input size.
+    private external fun recursiveBlur(
+        processor: Long,
+        radius: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the box blur filter to the indexed native output image, and copy it to the ARGB_8888
+    // outputBitmap of the input size.
+    private external fun boxBlur(
+        processor: Long,
+        radius: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the stacked box blur filter to the indexed native output image, and copy it to the
+    // ARGB_8888 outputBitmap of the input size.
+    private external fun stackedBoxBlur(
+        processor: Long,
+        radius: Float,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Apply the fused hue rotation, saturation and lookup tables to the indexed native output
+    // image, and copy it to the ARGB_8888 outputBitmap of the input size.
+    private external fun adjustColors(
+        processor: Long,
+        radian: Float,
+        saturation: Float,
+        red: ByteArray,
+        green: ByteArray,
+        blue: ByteArray,
+        alpha: ByteArray,
+        outputIndex: Int,
+        outputBitmap: Bitmap
+    ): Boolean
+
+    // Frees up any underlying native resources. After calling this method, the CPU processor must
+    // not be used in any way.
+    private external fun destroyCpuProcessor(processor: Long)
+
+    override fun configureInputAndOutput(inputImage: Bitmap, numberOfOutputImages: Int) {
+        val input = if (inputImage.config == Bitmap.Config.ARGB_8888) {
+            inputImage
+        } else {
+            inputImage.copy(Bitmap.Config.ARGB_8888, false)
+        }
+        val success = configureInputAndOutput(mCpuProcessor, input, numberOfOutputImages)
+        if (!success) throw RuntimeException("Failed to configureInputAndOutput")
+        mOutputImages = Array(numberOfOutputImages) {
+            Bitmap.createBitmap(input.width, input.height, Bitmap.Config.ARGB_8888)
+        }
+    }
+
+    override fun rotateHue(radian: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = rotateHue(mCpuProcessor, radian, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to rotateHue")
+        return outputImage
+    }
+
+    override fun blur(radius: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = blur(mCpuProcessor, radius, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to blur")
+        return outputImage
+    }
+
+    // Mix each pixel with its luminance by the saturation, equivalent to saturation.rs of the
+    // BasicRenderScript sample. A saturation of 0 turns the image to grayscale, and 1 keeps it
+    // unchanged.
+    fun saturation(saturation: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = saturation(mCpuProcessor, saturation, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to saturation")
+        return outputImage
+    }
+
+    // Approximate the gaussian blur of blur with a recursive filter, with a cost independent of the
+    // radius. The radius must be within the range of [1.0, 500.0].
+    fun recursiveBlur(radius: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = recursiveBlur(mCpuProcessor, radius, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to recursiveBlur")
+        return outputImage
+    }
+
+    // Blur filters with a cost independent of the radius. The radius must be within the range of
+    // [1.0, 500.0]. boxBlur applies a single box filter, and stackedBoxBlur applies three box
+    // filters approximating the gaussian of blur.
+    fun boxBlur(radius: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = boxBlur(mCpuProcessor, radius, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to boxBlur")
+        return outputImage
+    }
+
+    fun stackedBoxBlur(radius: Float, outputIndex: Int): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = stackedBoxBlur(mCpuProcessor, radius, outputIndex, outputImage)
+        if (!success) throw RuntimeException("Failed to stackedBoxBlur")
+        return outputImage
+    }
+
+    // Equivalent to rotateHue, then saturation, then the lookup tables of VulkanImageProcessor.lut,
+    // in a single pass over the image. Each table must hold 256 entries. The intermediate results
+    // are neither rounded to 8 bits nor clamped, so pixels with channels pushed out of range by the
+    // hue rotation or the saturation may differ from the separate filters.
+    fun adjustColors(
+        radian: Float,
+        saturation: Float,
+        red: ByteArray,
+        green: ByteArray,
+        blue: ByteArray,
+        alpha: ByteArray,
+        outputIndex: Int
+    ): Bitmap {
+        val outputImage = mOutputImages[outputIndex]
+        val success = adjustColors(
+            mCpuProcessor, radian, saturation, red, green, blue, alpha, outputIndex, outputImage
+        )
+        if (!success) throw RuntimeException("Failed to adjustColors")
+        return outputImage
+    }
+
+    override fun cleanup() {
+        if (mCpuProcessor != 0L) {
+            destroyCpuProcessor(mCpuProcessor)
+            mCpuProcessor = 0L
+        }
+    }
+}
@@ -92,7 +92,9 @@ class MainActivity : AppCompatActivity() {
             // Vulkan compute pipeline
             VulkanImageProcessor(this),
             // GLSL compute pipeline
-            GLSLImageProcessor()
+            GLSLImageProcessor(),
+            // Native multi-threaded CPU
+            CpuImageProcessor()
         )
 
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) {
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.android.example.rsmigration
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+// A list of Vulkan filters executed by VulkanImageProcessor.execute in a single JNI call, e.g. all
+// the filters of a frame. The commands are encoded into a direct buffer and decoded natively, see
+// CommandList.h for the layout. A list can be executed repeatedly, and reused after clear.
+class VulkanCommandList(private val maxCommands: Int = DEFAULT_MAX_COMMANDS) {
+    // The status of an executed command. The ordinals must match the native enum
+    // sample::CommandStatus.
+    enum class Status {
+        // The filter succeeded.
+        SUCCESS,
+
+        // The filter failed. The following commands were still executed.
+        FAILED,
+
+        // The command was rejected by the native decoder. The following commands were not
+        // executed.
+        INVALID,
+
+        // The command was not executed, as the list has not been executed since it was added.
+        NOT_EXECUTED
+    }
+
+    companion object {
+        private const val DEFAULT_MAX_COMMANDS = 64
+
+        // The opcodes must match the native enum sample::CommandOpcode.
+        private const val ROTATE_HUE = 0
+        private const val BLUR = 1
+        private const val BOX_BLUR = 2
+        private const val STACKED_BOX_BLUR = 3
+        private const val PYRAMID_BLUR = 4
+        private const val WAIT_FOR_COMPLETION = 5
+
+        // The opcode, the output index, and at most two parameters of 4 bytes each.
+        private const val MAX_COMMAND_SIZE = 16
+
+        // Must match sample::kCommandResultSize.
+        private const val RESULT_SIZE = 16
+    }
+
+    internal val commands: ByteBuffer =
+        ByteBuffer.allocateDirect(maxCommands * MAX_COMMAND_SIZE).order(ByteOrder.nativeOrder())
+    internal val results: ByteBuffer =
+        ByteBuffer.allocateDirect(maxCommands * RESULT_SIZE).order(ByteOrder.nativeOrder())
+
+    // The number of commands added.
+    var size = 0
+        private set
+
+    // The number of results written by the last execution.
+    internal var numResults = 0
+
+    // Append a filter writing the result to the indexed output image.
+    fun rotateHue(radian: Float, outputIndex: Int) = add(ROTATE_HUE, outputIndex, radian)
+    fun blur(radius: Float, outputIndex: Int) = add(BLUR, outputIndex, radius)
+    fun boxBlur(radius: Float, outputIndex: Int) = add(BOX_BLUR, outputIndex, radius)
+    fun stackedBoxBlur(radius: Float, outputIndex: Int) =
+        add(STACKED_BOX_BLUR, outputIndex, radius)
+    fun pyramidBlur(radius: Float, quality: Float, outputIndex: Int) =
+        add(PYRAMID_BLUR, outputIndex, radius, quality)
+
+    // Append a wait for the previous commands to finish on the device. The output images must not
+    // be read before a list ending with this command has been executed.
+    fun waitForCompletion() = add(WAIT_FOR_COMPLETION, 0)
+
+    // Remove all commands.
+    fun clear() {
+        commands.clear()
+        size = 0
+        numResults = 0
+    }
+
+    // Return the status of the indexed command of the last execution.
+    fun status(index: Int): Status {
+        checkIndex(index)
+        if (index >= numResults) return Status.NOT_EXECUTED
+        return Status.values()[results.getInt(index * RESULT_SIZE)]
+    }
+
+    // Return the time in nanoseconds spent by the indexed command of the last execution on the
+    // host. The filters return once submitted, so only waitForCompletion includes the device time.
+    fun elapsedNanos(index: Int): Long {
+        checkIndex(index)
+        if (index >= numResults) return 0L
+        return results.getLong(index * RESULT_SIZE + 8)
+    }
+
+    private fun add(opcode: Int, outputIndex: Int, vararg parameters: Float): VulkanCommandList {
+        if (size >= maxCommands) throw IllegalStateException("Too many commands")
+        commands.putInt(opcode)
+        commands.putInt(outputIndex)
+        for (parameter in parameters) commands.putFloat(parameter)
+        size += 1
+        numResults = 0
+        return this
+    }
+
+    private fun checkIndex(index: Int) {
+        if (index < 0 || index >= size) throw IndexOutOfBoundsException("Command index $index")
+    }
+}
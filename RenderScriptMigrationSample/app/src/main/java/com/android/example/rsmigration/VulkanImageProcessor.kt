@@ -19,12 +19,33 @@ package com.android.example.rsmigration
 import android.content.Context
 import android.content.res.AssetManager
 import android.graphics.Bitmap
+import android.graphics.Rect
 import android.hardware.HardwareBuffer
+import android.view.Surface
+import java.nio.ByteBuffer
+import java.util.concurrent.Callable
+import java.util.concurrent.Future
+import java.util.concurrent.FutureTask
+import java.util.concurrent.TimeUnit
 
 
 class VulkanImageProcessor(context: Context) : ImageProcessor {
     override val name = "Vulkan"
 
+    // The resampling filters for resizing the input image. The ordinals must match the native
+    // enum sample::cpu::ResizeFilter.
+    enum class ResizeFilter {
+        BILINEAR, BICUBIC, LANCZOS
+    }
+
+    companion object {
+        // Must match ImageProcessor::kNumReadbackBuffers.
+        private const val NUM_READBACK_BUFFERS = 2
+
+        // Must match ImageProcessor::kWindowOutput.
+        private const val WINDOW_OUTPUT = -1
+    }
+
     private var mVulkanProcessor = initVulkanProcessor(context.assets)
 
     init {
@@ -35,18 +56,43 @@ class VulkanImageProcessor(context: Context) : ImageProcessor {
 
     private lateinit var mOutputImages: Array<Bitmap>
 
+    // The readbacks not finished yet, from the oldest to the newest. The native processor
+    // alternates between NUM_READBACK_BUFFERS buffers, so the oldest must be finished before the
+    // buffer is reused.
+    private val mPendingReadbacks = ArrayDeque<Readback>()
+
+    // A readback finished by the first call to get, on the calling thread.
+    private inner class Readback(handle: Long, bitmap: Bitmap) : FutureTask<Bitmap>(Callable {
+        if (!finishReadback(handle, bitmap)) throw RuntimeException("Failed to readback")
+        bitmap
+    }) {
+        override fun get(): Bitmap {
+            run()
+            return super.get()
+        }
+
+        override fun get(timeout: Long, unit: TimeUnit): Bitmap {
+            run()
+            return super.get(timeout, unit)
+        }
+    }
+
     // Native methods
 
     // Initialize the image processor backed by Vulkan.
     // Return a non-zero handle on success, and 0L if failed.
     private external fun initVulkanProcessor(assetManager: AssetManager): Long
 
-    // Set the input image from bitmap and allocate output images backed by AHardwareBuffers.
+    // Set the input image from bitmap, resized to width x height with the given ResizeFilter
+    // ordinal, and allocate output images backed by AHardwareBuffers.
     // Return true on success, and false if failed.
     private external fun configureInputAndOutput(
         processor: Long,
         inputBitmap: Bitmap,
-        numberOfOutputImages: Int
+        numberOfOutputImages: Int,
+        width: Int,
+        height: Int,
+        resizeFilter: Int
     ): Boolean
 
     // Get the HardwareBuffer of the target output. This method must be invoked after
@@ -54,18 +100,157 @@ class VulkanImageProcessor(context: Context) : ImageProcessor {
     // Return null if failed.
     private external fun getOutputHardwareBuffer(processor: Long, index: Int): HardwareBuffer?
 
+    // Block until the commands submitted by the filters below have finished. The filters return
+    // as soon as their commands are submitted, so the output images must not be read before this.
+    private external fun waitForCompletion(processor: Long): Boolean
+
     // Apply the hue rotation filter in Vulkan and write the results to the indexed output image.
     private external fun rotateHue(processor: Long, radian: Float, outputIndex: Int): Boolean
 
+    // Apply the saturation filter in Vulkan and write the results to the indexed output image.
+    private external fun saturation(processor: Long, saturation: Float, outputIndex: Int): Boolean
+
     // Apply the blur filter in Vulkan and write the results to the indexed output image.
     private external fun blur(processor: Long, radius: Float, outputIndex: Int): Boolean
 
+    // Copy the pixels of the ARGB_8888 inputBitmap within the rect [left, right) x [top, bottom) to
+    // the input image.
+    private external fun updateInput(
+        processor: Long,
+        inputBitmap: Bitmap,
+        left: Int,
+        top: Int,
+        right: Int,
+        bottom: Int
+    ): Boolean
+
+    // Same as rotateHue, saturation and blur above, but only update the region of the indexed
+    // output image affected by the damaged rect [left, right) x [top, bottom) of the input image.
+    private external fun rotateHueDamaged(
+        processor: Long,
+        radian: Float,
+        outputIndex: Int,
+        left: Int,
+        top: Int,
+        right: Int,
+        bottom: Int
+    ): Boolean
+
+    private external fun saturationDamaged(
+        processor: Long,
+        saturation: Float,
+        outputIndex: Int,
+        left: Int,
+        top: Int,
+        right: Int,
+        bottom: Int
+    ): Boolean
+
+    private external fun blurDamaged(
+        processor: Long,
+        radius: Float,
+        outputIndex: Int,
+        left: Int,
+        top: Int,
+        right: Int,
+        bottom: Int
+    ): Boolean
+
+    // Apply the box blur filters in Vulkan and write the results to the indexed output image.
+    private external fun boxBlur(processor: Long, radius: Float, outputIndex: Int): Boolean
+    private external fun stackedBoxBlur(processor: Long, radius: Float, outputIndex: Int): Boolean
+
+    // Apply the pyramid blur filter in Vulkan and write the results to the indexed output image.
+    private external fun pyramidBlur(
+        processor: Long,
+        radius: Float,
+        quality: Float,
+        outputIndex: Int
+    ): Boolean
+
+    // Compute the per-channel histograms of the input image in Vulkan into histogram, which must
+    // have 256 * 4 elements.
+    private external fun histogram(processor: Long, histogram: IntArray): Boolean
+
+    // Apply the per-channel lookup tables in Vulkan and write the results to the indexed output
+    // image. Each table must have 256 elements.
+    private external fun lut(
+        processor: Long,
+        red: ByteArray,
+        green: ByteArray,
+        blue: ByteArray,
+        alpha: ByteArray,
+        outputIndex: Int
+    ): Boolean
+
+    // Apply the 3D lookup table in Vulkan and write the results to the indexed output image.
+    private external fun lut3D(
+        processor: Long,
+        table: ByteArray,
+        sizeX: Int,
+        sizeY: Int,
+        sizeZ: Int,
+        outputIndex: Int
+    ): Boolean
+
+    // Copy the indexed output image to the host without waiting for the copy.
+    // Return a non-zero handle to finishReadback, and 0L if failed.
+    private external fun readback(processor: Long, outputIndex: Int): Long
+
+    // Wait for the readback, copy the pixels into the ARGB_8888 bitmap of the output size, and
+    // release the handle. The bitmap may be null to only release the handle.
+    private external fun finishReadback(readback: Long, bitmap: Bitmap?): Boolean
+
+    // Execute the first commandsSize bytes of the encoded command list in the direct buffer
+    // commands, and write the results to the direct buffer results.
+    // Return the number of results, or -1 if failed.
+    private external fun executeCommandList(
+        processor: Long,
+        commands: ByteBuffer,
+        commandsSize: Int,
+        results: ByteBuffer
+    ): Int
+
+    // Limit the device memory used by the processor to budget bytes, or 0 for no limit.
+    private external fun setMemoryBudget(processor: Long, budget: Long): Boolean
+
+    // Cache the filter results in at most budget bytes of device memory with the parameters
+    // quantized to multiples of step, or disable the cache if budget is 0.
+    private external fun setResultCache(processor: Long, budget: Long, step: Float): Boolean
+
+    // Present the filter results with outputIndex WINDOW_OUTPUT to the surface, or stop presenting
+    // if the surface is null.
+    private external fun setOutputSurface(processor: Long, surface: Surface?): Boolean
+
+    // Return the device memory in bytes allocated by the processor for its images.
+    private external fun getMemoryUsage(processor: Long): Long
+
     // Frees up any underlying native resources. After calling this method, the Vulkan processor
     // must not be used in any way.
     private external fun destroyVulkanProcessor(processor: Long)
 
     override fun configureInputAndOutput(inputImage: Bitmap, numberOfOutputImages: Int) {
-        val success = configureInputAndOutput(mVulkanProcessor, inputImage, numberOfOutputImages)
+        configureInputAndOutput(
+            inputImage, numberOfOutputImages, inputImage.width, inputImage.height,
+            ResizeFilter.BICUBIC
+        )
+    }
+
+    // Same as configureInputAndOutput, but resize the input image to width x height on the GPU
+    // first. All the filters and output images then work at the resized size, e.g. the screen size
+    // for a preview, without ever producing a full resolution output.
+    fun configureInputAndOutput(
+        inputImage: Bitmap,
+        numberOfOutputImages: Int,
+        width: Int,
+        height: Int,
+        filter: ResizeFilter
+    ) {
+        // The readback buffers are released with the output images.
+        finishPendingReadbacks()
+        val success = configureInputAndOutput(
+            mVulkanProcessor, inputImage, numberOfOutputImages, width, height, filter.ordinal
+        )
         if (!success) throw RuntimeException("Failed to configureInputAndOutput")
         mOutputImages = Array(numberOfOutputImages) { i ->
             val buffer = getOutputHardwareBuffer(mVulkanProcessor, i)
@@ -78,18 +263,223 @@ class VulkanImageProcessor(context: Context) : ImageProcessor {
     }
 
     override fun rotateHue(radian: Float, outputIndex: Int): Bitmap {
-        val success = rotateHue(mVulkanProcessor, radian, outputIndex)
+        val success =
+            rotateHue(mVulkanProcessor, radian, outputIndex) && waitForCompletion(mVulkanProcessor)
         if (!success) throw RuntimeException("Failed to rotateHue")
         return mOutputImages[outputIndex]
     }
 
     override fun blur(radius: Float, outputIndex: Int): Bitmap {
-        val success = blur(mVulkanProcessor, radius, outputIndex)
+        val success =
+            blur(mVulkanProcessor, radius, outputIndex) && waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to blur")
+        return mOutputImages[outputIndex]
+    }
+
+    // Mix each pixel with its luminance by the saturation, equivalent to saturation.rs of the
+    // BasicRenderScript sample. A saturation of 0 turns the image to grayscale, and 1 keeps it
+    // unchanged.
+    fun saturation(saturation: Float, outputIndex: Int): Bitmap {
+        val success = saturation(mVulkanProcessor, saturation, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to saturation")
+        return mOutputImages[outputIndex]
+    }
+
+    // Copy the pixels of inputImage within rect to the input image, e.g. after the user painted a
+    // mask or a stroke on the bitmap passed to configureInputAndOutput. The input image must not
+    // have been resized. Follow with the damaged variants of the filters below to update the
+    // outputs.
+    fun updateInput(inputImage: Bitmap, rect: Rect) {
+        val input = if (inputImage.config == Bitmap.Config.ARGB_8888) {
+            inputImage
+        } else {
+            inputImage.copy(Bitmap.Config.ARGB_8888, false)
+        }
+        val success =
+            updateInput(mVulkanProcessor, input, rect.left, rect.top, rect.right, rect.bottom)
+        if (!success) throw RuntimeException("Failed to updateInput")
+    }
+
+    // Same as rotateHue, saturation and blur, but only recompute the region of the output image
+    // affected by the damaged rect of the input image: the damage expanded by the radius for blur.
+    // The rest of the output image keeps the result of the previous filter written to it, so the
+    // cost is proportional to the size of the damage.
+    fun rotateHue(radian: Float, outputIndex: Int, damage: Rect): Bitmap {
+        val success = rotateHueDamaged(
+            mVulkanProcessor, radian, outputIndex, damage.left, damage.top, damage.right,
+            damage.bottom
+        ) && waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to rotateHue")
+        return mOutputImages[outputIndex]
+    }
+
+    fun saturation(saturation: Float, outputIndex: Int, damage: Rect): Bitmap {
+        val success = saturationDamaged(
+            mVulkanProcessor, saturation, outputIndex, damage.left, damage.top, damage.right,
+            damage.bottom
+        ) && waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to saturation")
+        return mOutputImages[outputIndex]
+    }
+
+    fun blur(radius: Float, outputIndex: Int, damage: Rect): Bitmap {
+        val success = blurDamaged(
+            mVulkanProcessor, radius, outputIndex, damage.left, damage.top, damage.right,
+            damage.bottom
+        ) && waitForCompletion(mVulkanProcessor)
         if (!success) throw RuntimeException("Failed to blur")
         return mOutputImages[outputIndex]
     }
 
+    // Blur filters with a cost independent of the radius. The radius must be within the range of
+    // [1.0, 500.0]. boxBlur applies a single box filter, and stackedBoxBlur applies three box
+    // filters approximating the gaussian of blur.
+    fun boxBlur(radius: Float, outputIndex: Int): Bitmap {
+        val success = boxBlur(mVulkanProcessor, radius, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to boxBlur")
+        return mOutputImages[outputIndex]
+    }
+
+    fun stackedBoxBlur(radius: Float, outputIndex: Int): Bitmap {
+        val success = stackedBoxBlur(mVulkanProcessor, radius, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to stackedBoxBlur")
+        return mOutputImages[outputIndex]
+    }
+
+    // Approximate the gaussian blur with a downsample/upsample image pyramid. The radius must be
+    // within the range of [1.0, 500.0]. The quality within the range of [0.0, 1.0] trades speed
+    // for the accuracy compared to blur.
+    fun pyramidBlur(radius: Float, quality: Float, outputIndex: Int): Bitmap {
+        val success = pyramidBlur(mVulkanProcessor, radius, quality, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to pyramidBlur")
+        return mOutputImages[outputIndex]
+    }
+
+    // Compute the per-channel histograms of the input image, equivalent to
+    // ScriptIntrinsicHistogram. Return 256 * 4 counts, the count of value v in channel c (RGBA) is
+    // at index v * 4 + c.
+    fun histogram(): IntArray {
+        val histogram = IntArray(256 * 4)
+        val success = histogram(mVulkanProcessor, histogram)
+        if (!success) throw RuntimeException("Failed to histogram")
+        return histogram
+    }
+
+    // Map each RGBA channel through a lookup table of 256 entries, equivalent to
+    // ScriptIntrinsicLUT.
+    fun lut(
+        red: ByteArray,
+        green: ByteArray,
+        blue: ByteArray,
+        alpha: ByteArray,
+        outputIndex: Int
+    ): Bitmap {
+        val success = lut(mVulkanProcessor, red, green, blue, alpha, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to lut")
+        return mOutputImages[outputIndex]
+    }
+
+    // Map the RGB color through a 3D lookup table with trilinear interpolation, equivalent to
+    // ScriptIntrinsic3DLUT. The table holds sizeX * sizeY * sizeZ RGBA colors, with the red index
+    // increasing the fastest, then green, then blue. Each size must be within [1, 256]. The alpha
+    // channel is preserved.
+    fun lut3D(table: ByteArray, sizeX: Int, sizeY: Int, sizeZ: Int, outputIndex: Int): Bitmap {
+        val success = lut3D(mVulkanProcessor, table, sizeX, sizeY, sizeZ, outputIndex) &&
+                waitForCompletion(mVulkanProcessor)
+        if (!success) throw RuntimeException("Failed to lut3D")
+        return mOutputImages[outputIndex]
+    }
+
+    // Present the filter results to the surface, e.g. the Surface of a SurfaceView, or stop
+    // presenting if the surface is null. The results are scaled to the surface size. The surface
+    // must be released with setOutputSurface(null) before it is destroyed.
+    fun setOutputSurface(surface: Surface?) {
+        val success = setOutputSurface(mVulkanProcessor, surface)
+        if (!success) throw RuntimeException("Failed to setOutputSurface")
+    }
+
+    // Apply the hue rotation filter and present the result to the output surface, without waiting
+    // for the filter or copying the result to an output bitmap. Presentation is paced by the
+    // display, so a call may block until a surface buffer is available.
+    fun rotateHueToSurface(radian: Float) {
+        val success = rotateHue(mVulkanProcessor, radian, WINDOW_OUTPUT)
+        if (!success) throw RuntimeException("Failed to rotateHueToSurface")
+    }
+
+    // Apply the blur filter and present the result to the output surface, see rotateHueToSurface.
+    fun blurToSurface(radius: Float) {
+        val success = blur(mVulkanProcessor, radius, WINDOW_OUTPUT)
+        if (!success) throw RuntimeException("Failed to blurToSurface")
+    }
+
+    // Return the indexed output image, which holds the result of the last filter written to it.
+    fun getOutputImage(index: Int): Bitmap = mOutputImages[index]
+
+    // Execute the commands of the list in order with a single native call, saving the JNI
+    // transition of each filter. The status and the time of each command can be queried from the
+    // list afterwards. Return true if all commands succeeded.
+    fun execute(commandList: VulkanCommandList): Boolean {
+        val numResults = executeCommandList(
+            mVulkanProcessor, commandList.commands, commandList.commands.position(),
+            commandList.results
+        )
+        if (numResults < 0) throw RuntimeException("Failed to execute")
+        commandList.numResults = numResults
+        return (0 until commandList.size).all {
+            commandList.status(it) == VulkanCommandList.Status.SUCCESS
+        }
+    }
+
+    // Read the indexed output image back into a new software bitmap, e.g. for saving the result.
+    // The copy is submitted after the previous filters without waiting, and the returned future
+    // waits for it on get. The copy may run while the caller consumes the previous readback. At
+    // most two readbacks are pending, requesting another one finishes the oldest first.
+    fun readback(outputIndex: Int): Future<Bitmap> {
+        mPendingReadbacks.removeAll { it.isDone }
+        while (mPendingReadbacks.size >= NUM_READBACK_BUFFERS) mPendingReadbacks.removeFirst().run()
+        val outputImage = mOutputImages[outputIndex]
+        val bitmap =
+            Bitmap.createBitmap(outputImage.width, outputImage.height, Bitmap.Config.ARGB_8888)
+        val handle = readback(mVulkanProcessor, outputIndex)
+        if (handle == 0L) throw RuntimeException("Failed to readback")
+        val readback = Readback(handle, bitmap)
+        mPendingReadbacks.addLast(readback)
+        return readback
+    }
+
+    // Finish the pending readbacks, so that the native readback buffers are no longer in use.
+    private fun finishPendingReadbacks() {
+        while (mPendingReadbacks.isNotEmpty()) mPendingReadbacks.removeFirst().run()
+    }
+
+    // Limit the device memory used by this processor to budget bytes, or 0 for no limit. The
+    // staging and intermediate images of the filters share one aliased allocation, which is
+    // released whenever the memory usage exceeds the budget. The next filter reallocates it.
+    fun setMemoryBudget(budget: Long) {
+        val success = setMemoryBudget(mVulkanProcessor, budget)
+        if (!success) throw RuntimeException("Failed to setMemoryBudget")
+    }
+
+    // Return the device memory in bytes currently allocated by this processor.
+    fun getMemoryUsage(): Long = getMemoryUsage(mVulkanProcessor)
+
+    // Cache the results of rotateHue, saturation and blur in at most budget bytes of device
+    // memory, or disable the cache if budget is 0. The parameters are rounded to multiples of
+    // step, e.g. 0.01 radian for a hue slider, so that scrubbing back and forth over the same
+    // values only copies the cached results. The least recently used results are evicted first,
+    // and the cache is dropped whenever the input image changes.
+    fun setResultCache(budget: Long, step: Float) {
+        val success = setResultCache(mVulkanProcessor, budget, step)
+        if (!success) throw RuntimeException("Failed to setResultCache")
+    }
+
     override fun cleanup() {
+        finishPendingReadbacks()
         if (mVulkanProcessor != 0L) {
             destroyVulkanProcessor(mVulkanProcessor)
             mVulkanProcessor = 0L